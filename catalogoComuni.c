@@ -0,0 +1,888 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USA_MMAP
+#define USA_SCHED_YIELD
+#define USA_PTHREAD
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "catalogoComuni.h"
+#include "codiciErrore.h"
+#include "ricercaComuni.h"
+
+// Costanti della funzione hash FNV-1a a 64 bit
+#define FNV_BASE 14695981039346656037u
+#define FNV_PRIMO 1099511628211u
+
+// Numero medio di nomi per gruppo nella costruzione dell'hash perfetto e numero massimo di spostamenti tentati
+#define NOMI_PER_GRUPPO 4
+#define MAX_SPOSTAMENTO (1u << 24)
+
+// Sostituzione di ogni byte ASCII nella chiave normalizzata: le lettere minuscole diventano maiuscole, mentre
+// tabulazioni, spazi, apostrofi, trattini e punti vengono eliminati (valore 0). Gli altri byte restano invariati
+static const unsigned char CHIAVE_ASCII[128] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 0, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    0, '!', '"', '#', '$', '%', '&', 0, '(', ')', '*', '+', ',', 0, 0, '/',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', ':', ';', '<', '=', '>', '?',
+    '@', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',
+    'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '[', '\\', ']', '^', '_',
+    0, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',
+    'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '{', '|', '}', '~', 127
+};
+
+// Lettera semplice corrispondente ai caratteri UTF-8 da U+00C0 a U+00FF (secondo byte da 0xC0 a 0xFF dopo 0xC3,
+// indicizzato dal secondo byte - 0x80). Il valore 0 indica un carattere privo di lettera semplice, copiato invariato
+static const unsigned char LETTERA_LATINA[64] = {
+    'A', 'A', 'A', 'A', 'A', 'A', 'A', 'C', 'E', 'E', 'E', 'E', 'I', 'I', 'I', 'I',
+    'D', 'N', 'O', 'O', 'O', 'O', 'O', 0, 'O', 'U', 'U', 'U', 'U', 'Y', 0, 'S',
+    'A', 'A', 'A', 'A', 'A', 'A', 'A', 'C', 'E', 'E', 'E', 'E', 'I', 'I', 'I', 'I',
+    'D', 'N', 'O', 'O', 'O', 'O', 'O', 0, 'O', 'U', 'U', 'U', 'U', 'Y', 0, 'Y'
+};
+
+size_t NormalizzaNome(const char nome[], size_t lenNome, char chiave[LEN_MAX_CHIAVE]){
+    const unsigned char *c = (const unsigned char*)nome;
+    size_t len = 0;
+    for(size_t i=0; i<lenNome; i++){
+        unsigned char sostituto;
+        if(c[i] < 0x80){
+            sostituto = CHIAVE_ASCII[c[i]];
+            if(sostituto == 0){
+                continue;
+            }
+        }
+        else if(c[i] == 0xC3 && i + 1 < lenNome && c[i + 1] >= 0x80 && c[i + 1] <= 0xBF
+                && LETTERA_LATINA[c[i + 1] - 0x80] != 0){
+            // Lettera accentata dell'alfabeto latino
+            sostituto = LETTERA_LATINA[c[i + 1] - 0x80];
+            i++;
+        }
+        else if(i + 1 < lenNome && (c[i] == 0xCC || (c[i] == 0xCD && c[i + 1] <= 0xAF))){
+            // Accento combinante (da U+0300 a U+036F) che segue la lettera a cui si riferisce
+            i++;
+            continue;
+        }
+        else if(c[i] == 0xE2 && i + 2 < lenNome && c[i + 1] == 0x80 && (c[i + 2] == 0x98 || c[i + 2] == 0x99)){
+            // Apostrofo tipografico (U+2018 e U+2019)
+            i += 2;
+            continue;
+        }
+        else{
+            sostituto = c[i];
+        }
+        if(len == LEN_MAX_CHIAVE){
+            return 0;
+        }
+        chiave[len++] = (char)sostituto;
+    }
+    return len;
+}
+
+uint64_t HashChiave(const char chiave[], size_t lenChiave){
+    uint64_t hash = FNV_BASE;
+    for(size_t i=0; i<lenChiave; i++){
+        hash ^= (unsigned char)chiave[i];
+        hash *= FNV_PRIMO;
+    }
+    return hash;
+}
+
+// Ricava dall'hash di un nome un valore a 32 bit diverso per ogni seme, senza dover scandire nuovamente il nome
+static uint32_t Mescola(uint64_t hash, uint32_t seme){
+    hash ^= seme * 0x9E3779B97F4A7C15u;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDu;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53u;
+    hash ^= hash >> 33;
+    return (uint32_t)hash;
+}
+
+// Confronta la chiave di un comune con una chiave normalizzata
+static inline bool ChiaveUguale(const comune *c, const char chiave[], size_t lenChiave){
+    return c->lenChiave == lenChiave && memcmp(c->chiave, chiave, lenChiave) == 0;
+}
+
+// Confronta il nome di un comune con quello cercato senza distinzione tra maiuscole e minuscole (lettere ASCII)
+static bool NomeUguale(const comune *c, const char nome[], size_t lenNome){
+    if(c->lenNome != lenNome){
+        return false;
+    }
+    for(size_t i=0; i<lenNome; i++){
+        unsigned char a = (unsigned char)c->nome[i], b = (unsigned char)nome[i];
+        if(a != b && !(a < 0x80 && b < 0x80 && (a | 0x20) == (b | 0x20) && (a | 0x20) >= 'a' && (a | 0x20) <= 'z')){
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tra i comuni con la stessa chiave restituisce quello il cui nome coincide con quello cercato oppure il primo
+static const comune* ScegliOmonimo(const catalogo *cat, const comune *primo, const char nome[], size_t lenNome){
+    if(primo->omonimo == 0){
+        return primo;
+    }
+    for(const comune *c = primo; ; c = &cat->comuni[c->omonimo - 1]){
+        if(NomeUguale(c, nome, lenNome)){
+            return c;
+        }
+        if(c->omonimo == 0){
+            return primo;
+        }
+    }
+}
+
+// Converte in maiuscolo la sigla di una provincia. Restituisce false (lasciando la sigla invariata) se non è composta
+// da due lettere
+static bool LeggiSigla(const char testo[LEN_SIGLA_PROVINCIA], char provincia[LEN_SIGLA_PROVINCIA]){
+    char sigla[LEN_SIGLA_PROVINCIA];
+    for(int i=0; i<LEN_SIGLA_PROVINCIA; i++){
+        unsigned char c = (unsigned char)testo[i];
+        if(c >= 0x80 || CHIAVE_ASCII[c] < 'A' || CHIAVE_ASCII[c] > 'Z'){
+            return false;
+        }
+        sigla[i] = (char)CHIAVE_ASCII[c];
+    }
+    memcpy(provincia, sigla, LEN_SIGLA_PROVINCIA);
+    return true;
+}
+
+#ifdef USA_MMAP
+// Mappa in memoria l'intero file in sola lettura: il contenuto viene caricato dal sistema operativo alla prima lettura
+const char* MappaFile(const char nomeFile[], size_t *lenTesto, bool *mappato){
+    int fd = open(nomeFile, O_RDONLY);
+    if(fd < 0){
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0){
+        close(fd);
+        return NULL;
+    }
+    void *testo = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(testo == MAP_FAILED){
+        return NULL;
+    }
+    *lenTesto = (size_t)info.st_size;
+    *mappato = true;
+    return testo;
+}
+#else
+// Sui sistemi privi di mmap il file viene letto in un unico buffer
+const char* MappaFile(const char nomeFile[], size_t *lenTesto, bool *mappato){
+    FILE *file = fopen(nomeFile, "rb");
+    if(file == NULL){
+        return NULL;
+    }
+    size_t capacita = 1 << 17, len = 0, letti;
+    char *testo = malloc(capacita);
+    while(testo != NULL && (letti = fread(testo + len, 1, capacita - len, file)) > 0){
+        len += letti;
+        if(len == capacita){
+            // Il buffer è pieno: ne raddoppio la dimensione
+            char *nuovo = realloc(testo, capacita * 2);
+            if(nuovo == NULL){
+                free(testo);
+                testo = NULL;
+                break;
+            }
+            testo = nuovo;
+            capacita *= 2;
+        }
+    }
+    fclose(file);
+    *lenTesto = len;
+    *mappato = false;
+    return testo;
+}
+#endif
+
+// Inserisce nella tabella hash il comune di indice passato come parametro.
+// In caso di chiavi duplicate nella tabella resta la prima occorrenza, come avveniva con la lettura sequenziale del
+// file, e le successive vengono accodate all'elenco dei suoi omonimi
+static void InserisciComune(const catalogo *cat, uint32_t tabella[], comune comuni[], uint32_t indice){
+    const comune *c = &comuni[indice];
+    if(c->lenChiave == 0){
+        return;
+    }
+    uint32_t pos = Mescola(HashChiave(c->chiave, c->lenChiave), 0) & cat->maschera;
+    while(tabella[pos] != 0){
+        comune *presente = &comuni[tabella[pos] - 1];
+        if(ChiaveUguale(presente, c->chiave, c->lenChiave)){
+            while(presente->omonimo != 0){
+                presente = &comuni[presente->omonimo - 1];
+            }
+            presente->omonimo = indice + 1;
+            return;
+        }
+        pos = (pos + 1) & cat->maschera;
+    }
+    tabella[pos] = indice + 1;
+}
+
+// Conta le righe del testo indicato
+static uint32_t ContaRighe(const char testo[], size_t lenTesto){
+    uint32_t numRighe = 1;
+    for(size_t i=0; i<lenTesto; i++){
+        if(testo[i] == '\n'){
+            numRighe++;
+        }
+    }
+    return numRighe;
+}
+
+// Accoda ai comuni del catalogo quelli contenuti nel testo indicato. Ogni riga ha il formato
+// "<luogo di nascita>;<codice catastale>[;<sigla>]". I nomi non vengono copiati: il catalogo ne memorizza unicamente
+// la posizione all'interno del testo e la lunghezza
+static void LeggiComuni(catalogo *cat, comune comuni[], char chiavi[], size_t *lenChiavi, const char testo[],
+                        size_t lenTesto){
+    const char *riga = testo, *fine = testo + lenTesto;
+    if(lenTesto >= LEN_BOM && memcmp(riga, BOM_UTF8, LEN_BOM) == 0){
+        // Il file può iniziare con il BOM UTF-8 che non fa parte del nome del primo comune
+        riga += LEN_BOM;
+    }
+    while(riga < fine){
+        const char *fineRiga = memchr(riga, '\n', (size_t)(fine - riga));
+        if(fineRiga == NULL){
+            fineRiga = fine;
+        }
+        const char *separatore = memchr(riga, DIV_CHAR, (size_t)(fineRiga - riga));
+        // Le righe prive di separatore o con un codice di lunghezza errata vengono ignorate
+        if(separatore != NULL && separatore > riga && fineRiga - separatore > LEN_COD_CATASTALE){
+            comune *c = &comuni[cat->numComuni++];
+            c->nome = riga;
+            c->lenNome = (uint32_t)(separatore - riga);
+            c->omonimo = 0;
+            // Un nome più lungo di LEN_MAX_CHIAVE ha chiave vuota e non può essere cercato per nome
+            char chiave[LEN_MAX_CHIAVE];
+            c->chiave = chiavi + *lenChiavi;
+            c->lenChiave = (uint32_t)NormalizzaNome(c->nome, c->lenNome, chiave);
+            memcpy(chiavi + *lenChiavi, chiave, c->lenChiave);
+            *lenChiavi += c->lenChiave;
+            memcpy(c->codice, separatore + 1, LEN_COD_CATASTALE);
+            // Sigla della provincia facoltativa dopo il codice catastale
+            const char *sigla = separatore + 1 + LEN_COD_CATASTALE;
+            memset(c->provincia, ' ', LEN_SIGLA_PROVINCIA);
+            if(fineRiga - sigla > LEN_SIGLA_PROVINCIA && sigla[0] == DIV_CHAR){
+                LeggiSigla(sigla + 1, c->provincia);
+            }
+        }
+        riga = fineRiga + 1;
+    }
+}
+
+int CaricaCatalogo(catalogo *cat, const char nomeFile[], const char nomeFileEsteri[]){
+    memset(cat, 0, sizeof(*cat));
+    cat->testo = MappaFile(nomeFile, &cat->lenTesto, &cat->mappato);
+    if(cat->testo == NULL){
+        return ERR_CATALOGO;
+    }
+    // L'elenco degli stati esteri è facoltativo: se manca il catalogo contiene unicamente i comuni italiani
+    if(nomeFileEsteri != NULL){
+        cat->testoEsteri = MappaFile(nomeFileEsteri, &cat->lenTestoEsteri, &cat->mappatoEsteri);
+    }
+
+    // Conto le righe per dimensionare gli array in un'unica allocazione. Le chiavi normalizzate non sono mai più lunghe
+    // dei nomi e occupano quindi al più quanto il testo dei file
+    uint32_t numRighe = ContaRighe(cat->testo, cat->lenTesto) + ContaRighe(cat->testoEsteri, cat->lenTestoEsteri);
+    comune *comuni = malloc(numRighe * sizeof(comune));
+    char *chiavi = malloc(cat->lenTesto + cat->lenTestoEsteri);
+    cat->comuni = comuni;
+    cat->chiavi = chiavi;
+    if(comuni == NULL || chiavi == NULL){
+        LiberaCatalogo(cat);
+        return ERR_ALLOCAZIONE;
+    }
+
+    // Gli stati esteri seguono i comuni: in caso di nomi coincidenti il comune italiano resta il primo omonimo
+    size_t lenChiavi = 0;
+    LeggiComuni(cat, comuni, chiavi, &lenChiavi, cat->testo, cat->lenTesto);
+    if(cat->testoEsteri != NULL){
+        LeggiComuni(cat, comuni, chiavi, &lenChiavi, cat->testoEsteri, cat->lenTestoEsteri);
+    }
+
+    // La tabella hash viene mantenuta piena al massimo per metà in modo da avere sequenze di scansione brevi
+    uint32_t dimensione = 16;
+    while(dimensione < cat->numComuni * 2){
+        dimensione <<= 1;
+    }
+    uint32_t *tabella = calloc(dimensione, sizeof(uint32_t));
+    cat->tabella = tabella;
+    if(tabella == NULL){
+        LiberaCatalogo(cat);
+        return ERR_ALLOCAZIONE;
+    }
+    cat->maschera = dimensione - 1;
+    for(uint32_t i=0; i<cat->numComuni; i++){
+        InserisciComune(cat, tabella, comuni, i);
+    }
+
+    // Indice inverso per codice catastale: in caso di codici duplicati viene mantenuta la prima occorrenza
+    uint16_t *perCodice = calloc(NUM_CODICI_CATASTALI, sizeof(uint16_t));
+    cat->perCodice = perCodice;
+    if(perCodice == NULL){
+        LiberaCatalogo(cat);
+        return ERR_ALLOCAZIONE;
+    }
+    for(uint32_t i=0; i<cat->numComuni && i < UINT16_MAX; i++){
+        int indice = IndiceCodiceCatastale(cat->comuni[i].codice);
+        if(indice >= 0 && perCodice[indice] == 0){
+            perCodice[indice] = (uint16_t)(i + 1);
+        }
+    }
+    return 0;
+}
+
+int CostruisciHashPerfetto(catalogo *cat){
+    // I nomi distinti sono esattamente quelli presenti nella tabella hash ad indirizzamento aperto
+    uint32_t numNomi = 0;
+    for(uint32_t i=0; i<=cat->maschera; i++){
+        if(cat->tabella[i] != 0){
+            numNomi++;
+        }
+    }
+    if(numNomi == 0){
+        return ERR_CATALOGO;
+    }
+    uint32_t numGruppi = numNomi / NOMI_PER_GRUPPO + 1;
+    uint64_t *hash = malloc(numNomi * sizeof(uint64_t));
+    uint32_t *indici = malloc(numNomi * sizeof(uint32_t));
+    uint32_t *inizioGruppo = calloc(numGruppi + 1, sizeof(uint32_t));
+    uint32_t *riempimento = malloc(numGruppi * sizeof(uint32_t));
+    uint32_t *ordineGruppi = malloc(numGruppi * sizeof(uint32_t));
+    uint32_t *spostamenti = calloc(numGruppi, sizeof(uint32_t));
+    uint32_t *posizioni = malloc(numNomi * sizeof(uint32_t));
+    bool *occupate = calloc(numNomi, sizeof(bool));
+    uint32_t *provvisorie = malloc(numNomi * sizeof(uint32_t));
+    int errore = 0;
+    if(hash == NULL || indici == NULL || inizioGruppo == NULL || riempimento == NULL || ordineGruppi == NULL || spostamenti == NULL
+       || posizioni == NULL || occupate == NULL || provvisorie == NULL){
+        errore = ERR_ALLOCAZIONE;
+    }
+
+    if(errore == 0){
+        // Suddivido i nomi in gruppi (ordinamento per conteggio) in base all'hash con seme 0
+        for(uint32_t i=0; i<=cat->maschera; i++){
+            if(cat->tabella[i] != 0){
+                const comune *c = &cat->comuni[cat->tabella[i] - 1];
+                inizioGruppo[Mescola(HashChiave(c->chiave, c->lenChiave), 0) % numGruppi + 1]++;
+            }
+        }
+        for(uint32_t g=0; g<numGruppi; g++){
+            inizioGruppo[g + 1] += inizioGruppo[g];
+            ordineGruppi[g] = g;
+        }
+        memcpy(riempimento, inizioGruppo, numGruppi * sizeof(uint32_t));
+        for(uint32_t i=0; i<=cat->maschera; i++){
+            if(cat->tabella[i] != 0){
+                const comune *c = &cat->comuni[cat->tabella[i] - 1];
+                uint64_t h = HashChiave(c->chiave, c->lenChiave);
+                uint32_t pos = riempimento[Mescola(h, 0) % numGruppi]++;
+                hash[pos] = h;
+                indici[pos] = cat->tabella[i] - 1;
+            }
+        }
+
+        // I gruppi più numerosi vengono sistemati per primi, quando le posizioni libere sono ancora molte
+        for(uint32_t i=1; i<numGruppi; i++){
+            uint32_t g = ordineGruppi[i], j = i;
+            uint32_t dim = inizioGruppo[g + 1] - inizioGruppo[g];
+            while(j > 0 && inizioGruppo[ordineGruppi[j - 1] + 1] - inizioGruppo[ordineGruppi[j - 1]] < dim){
+                ordineGruppi[j] = ordineGruppi[j - 1];
+                j--;
+            }
+            ordineGruppi[j] = g;
+        }
+
+        // Per ogni gruppo cerco uno spostamento che collochi tutti i suoi nomi in posizioni libere e distinte
+        for(uint32_t i=0; i<numGruppi && errore == 0; i++){
+            uint32_t g = ordineGruppi[i], inizio = inizioGruppo[g], fine = inizioGruppo[g + 1];
+            if(inizio == fine){
+                continue;
+            }
+            uint32_t spostamento;
+            for(spostamento=1; spostamento<MAX_SPOSTAMENTO; spostamento++){
+                uint32_t k;
+                for(k=inizio; k<fine; k++){
+                    provvisorie[k - inizio] = Mescola(hash[k], spostamento) % numNomi;
+                    if(occupate[provvisorie[k - inizio]]){
+                        break;
+                    }
+                    occupate[provvisorie[k - inizio]] = true;
+                }
+                if(k == fine){
+                    break;
+                }
+                // Collisione: libero le posizioni occupate provvisoriamente e provo lo spostamento successivo
+                while(k > inizio){
+                    k--;
+                    occupate[provvisorie[k - inizio]] = false;
+                }
+            }
+            if(spostamento == MAX_SPOSTAMENTO){
+                errore = ERR_CATALOGO;
+                break;
+            }
+            spostamenti[g] = spostamento;
+            for(uint32_t k=inizio; k<fine; k++){
+                posizioni[provvisorie[k - inizio]] = indici[k];
+            }
+        }
+    }
+
+    free(hash);
+    free(indici);
+    free(inizioGruppo);
+    free(riempimento);
+    free(ordineGruppi);
+    free(occupate);
+    free(provvisorie);
+    if(errore != 0){
+        free(spostamenti);
+        free(posizioni);
+        return errore;
+    }
+    cat->spostamenti = spostamenti;
+    cat->numGruppi = numGruppi;
+    cat->posizioni = posizioni;
+    cat->numPosizioni = numNomi;
+    return 0;
+}
+
+// Restituisce il primo comune con la chiave normalizzata del nome indicato oppure NULL se il comune non esiste
+static const comune* CercaChiave(const catalogo *cat, const char nome[], size_t lenNome){
+    char chiave[LEN_MAX_CHIAVE];
+    size_t lenChiave = NormalizzaNome(nome, lenNome, chiave);
+    if(lenChiave == 0){
+        return NULL;
+    }
+    uint64_t hash = HashChiave(chiave, lenChiave);
+    if(cat->spostamenti != NULL){
+        // Hash perfetto minimo: un solo accesso alla tabella e un solo confronto
+        uint32_t spostamento = cat->spostamenti[Mescola(hash, 0) % cat->numGruppi];
+        const comune *c = &cat->comuni[cat->posizioni[Mescola(hash, spostamento) % cat->numPosizioni]];
+        return ChiaveUguale(c, chiave, lenChiave) ? c : NULL;
+    }
+
+    uint32_t pos = Mescola(hash, 0) & cat->maschera;
+    while(cat->tabella[pos] != 0){
+        const comune *c = &cat->comuni[cat->tabella[pos] - 1];
+        if(ChiaveUguale(c, chiave, lenChiave)){
+            return c;
+        }
+        pos = (pos + 1) & cat->maschera;
+    }
+    return NULL;
+}
+
+const comune* CercaComune(const catalogo *cat, const char nome[], size_t lenNome){
+    const comune *c = CercaChiave(cat, nome, lenNome);
+    return c != NULL ? ScegliOmonimo(cat, c, nome, lenNome) : NULL;
+}
+
+size_t SeparaProvincia(const char luogo[], size_t lenLuogo, char provincia[LEN_SIGLA_PROVINCIA]){
+    memset(provincia, ' ', LEN_SIGLA_PROVINCIA);
+    size_t len = lenLuogo;
+    while(len > 0 && (luogo[len - 1] == ' ' || luogo[len - 1] == '\t')){
+        len--;
+    }
+    if(len < LEN_SIGLA_PROVINCIA + 2 || luogo[len - 1] != ')' || luogo[len - LEN_SIGLA_PROVINCIA - 2] != '('){
+        return lenLuogo;
+    }
+    if(!LeggiSigla(luogo + len - LEN_SIGLA_PROVINCIA - 1, provincia)){
+        return lenLuogo;
+    }
+    len -= LEN_SIGLA_PROVINCIA + 2;
+    while(len > 0 && (luogo[len - 1] == ' ' || luogo[len - 1] == '\t')){
+        len--;
+    }
+    return len;
+}
+
+const comune* ProssimoOmonimo(const catalogo *cat, const comune *c){
+    return c->omonimo != 0 ? &cat->comuni[c->omonimo - 1] : NULL;
+}
+
+int CercaComuneUnivoco(const catalogo *cat, const char luogo[], size_t lenLuogo, const comune **trovato){
+    char provincia[LEN_SIGLA_PROVINCIA];
+    size_t lenNome = SeparaProvincia(luogo, lenLuogo, provincia);
+    bool conProvincia = provincia[0] != ' ';
+    const comune *primo = CercaChiave(cat, luogo, lenNome);
+
+    // Tra i comuni con la stessa chiave (e della provincia indicata) vengono preferiti quelli il cui nome coincide
+    // esattamente con quello cercato: "Paterno" individua quindi un solo comune, mentre "Castro" ne individua due
+    const comune *scelto = NULL;
+    int numCandidati = 0, numEsatti = 0;
+    for(const comune *c = primo; c != NULL; c = ProssimoOmonimo(cat, c)){
+        if(conProvincia && memcmp(c->provincia, provincia, LEN_SIGLA_PROVINCIA) != 0){
+            continue;
+        }
+        bool esatto = NomeUguale(c, luogo, lenNome);
+        if(esatto && numEsatti++ == 0){
+            scelto = c;
+        }
+        if(numCandidati++ == 0 && numEsatti == 0){
+            scelto = c;
+        }
+    }
+    *trovato = scelto;
+    if(numCandidati == 0){
+        return ERR_LUOGO_NASCITA;
+    }
+    if(numEsatti > 1 || (numEsatti == 0 && numCandidati > 1)){
+        return ERR_LUOGO_AMBIGUO;
+    }
+    return 0;
+}
+
+int IndiceCodiceCatastale(const char codice[LEN_COD_CATASTALE]){
+    if(codice[0] < 'A' || codice[0] > 'Z'){
+        return -1;
+    }
+    int indice = codice[0] - 'A';
+    for(int i=1; i<LEN_COD_CATASTALE; i++){
+        if(codice[i] < '0' || codice[i] > '9'){
+            return -1;
+        }
+        indice = indice * 10 + (codice[i] - '0');
+    }
+    return indice;
+}
+
+const comune* CercaComunePerCodice(const catalogo *cat, const char codice[LEN_COD_CATASTALE]){
+    int indice = IndiceCodiceCatastale(codice);
+    if(indice < 0 || cat->perCodice[indice] == 0){
+        return NULL;
+    }
+    return &cat->comuni[cat->perCodice[indice] - 1];
+}
+
+void LiberaTesto(const char testo[], size_t lenTesto, bool mappato){
+#ifdef USA_MMAP
+    if(mappato){
+        munmap((void*)testo, lenTesto);
+    }
+#else
+    (void)lenTesto;
+    (void)mappato;
+    free((void*)testo);
+#endif
+}
+
+void LiberaCatalogo(catalogo *cat){
+    LiberaTesto(cat->testo, cat->lenTesto, cat->mappato);
+    LiberaTesto(cat->testoEsteri, cat->lenTestoEsteri, cat->mappatoEsteri);
+    free((void*)cat->comuni);
+    free((void*)cat->tabella);
+    free((void*)cat->spostamenti);
+    free((void*)cat->posizioni);
+    free((void*)cat->perCodice);
+    free((void*)cat->chiavi);
+    memset(cat, 0, sizeof(*cat));
+}
+
+// Versione del catalogo pubblicata per le ricerche: il catalogo e l'indice dei nomi costruito su di esso vengono
+// sostituiti insieme con un unico scambio atomico a ogni ricarica e liberati insieme
+typedef struct VERSIONE_CATALOGO {
+    const catalogo *cat;
+    _Atomic(indiceComuni*) indice;       // Costruito dalla ricarica oppure, per la prima versione, al primo utilizzo
+}versioneCatalogo;
+
+static _Atomic(versioneCatalogo*) versioneAttiva;
+
+// Dimensione di una linea di cache: ogni posizione di lettura occupa una linea propria, in modo che i thread non
+// scrivano mai sulla stessa linea durante le ricerche
+#define LEN_LINEA_CACHE 64
+
+// Posizione di lettura di un thread: durante una lettura contiene l'epoca osservata all'inizio, altrimenti 0.
+// Viene scritta solo dal thread a cui appartiene e letta solo dalle ricariche
+typedef struct POSIZIONE_LETTURA {
+    _Alignas(LEN_LINEA_CACHE) atomic_uint_fast64_t epoca;
+    unsigned annidamento;                // Letture in corso del thread (usato solo dal thread stesso)
+    atomic_bool occupata;                // La posizione appartiene ad un thread ancora in esecuzione
+    struct POSIZIONE_LETTURA *successiva;
+}posizioneLettura;
+
+// Epoca corrente, incrementata da ogni ricarica dopo lo scambio del catalogo: una lettura registrata con un'epoca
+// inferiore può aver ottenuto il catalogo precedente, una lettura registrata in seguito ottiene sicuramente il nuovo
+static atomic_uint_fast64_t epocaCorrente = 1;
+
+// Elenco delle posizioni di tutti i thread che hanno letto il catalogo. Le posizioni non vengono mai liberate: quelle
+// dei thread conclusi vengono riutilizzate dai nuovi thread
+static _Atomic(posizioneLettura*) elencoPosizioni;
+static _Thread_local posizioneLettura *posizioneThread;
+
+#ifdef USA_PTHREAD
+// Alla conclusione di un thread la sua posizione viene resa disponibile per altri thread
+static pthread_key_t chiavePosizione;
+static pthread_once_t chiavePosizioneCreata = PTHREAD_ONCE_INIT;
+
+static void RilasciaPosizione(void *arg){
+    posizioneLettura *posizione = arg;
+    atomic_store(&posizione->epoca, 0);
+    atomic_store(&posizione->occupata, false);
+}
+
+static void CreaChiavePosizione(void){
+    pthread_key_create(&chiavePosizione, RilasciaPosizione);
+}
+#endif
+
+// Impedisce che due ricariche si sovrappongano (le letture non lo consultano mai)
+static atomic_flag ricaricaInCorso = ATOMIC_FLAG_INIT;
+
+// Cede il processore ad altri thread durante un'attesa
+static void Cedi(void){
+#ifdef USA_SCHED_YIELD
+    sched_yield();
+#endif
+}
+
+// Libera un catalogo pubblicato, a meno che non sia quello incorporato nell'eseguibile
+static void LiberaCatalogoPubblicato(const catalogo *cat){
+#ifdef CATALOGO_INCORPORATO
+    if(cat == &CATALOGO_COMUNI_INCORPORATO){
+        return;
+    }
+#endif
+    if(cat != NULL){
+        LiberaCatalogo((catalogo*)cat);
+        free((void*)cat);
+    }
+}
+
+// Libera l'indice dei nomi allocato dinamicamente
+static void LiberaIndice(indiceComuni *indice){
+    if(indice != NULL){
+        LiberaIndiceComuni(indice);
+        free(indice);
+    }
+}
+
+// Costruisce l'indice dei nomi del catalogo allocandolo dinamicamente. Restituisce NULL in caso di errore
+static indiceComuni* NuovoIndice(const catalogo *cat){
+    indiceComuni *indice = malloc(sizeof(indiceComuni));
+    if(indice == NULL){
+        return NULL;
+    }
+    if(CostruisciIndiceComuni(indice, cat) != 0){
+        free(indice);
+        return NULL;
+    }
+    return indice;
+}
+
+// Libera una versione del catalogo insieme al suo indice
+static void LiberaVersione(versioneCatalogo *versione){
+    if(versione != NULL){
+        LiberaIndice(atomic_load(&versione->indice));
+        LiberaCatalogoPubblicato(versione->cat);
+        free(versione);
+    }
+}
+
+// Crea una versione del catalogo con l'indice indicato (anche NULL). Restituisce NULL in caso di errore di
+// allocazione, senza liberare il catalogo e l'indice
+static versioneCatalogo* NuovaVersione(const catalogo *cat, indiceComuni *indice){
+    versioneCatalogo *versione = malloc(sizeof(versioneCatalogo));
+    if(versione == NULL){
+        return NULL;
+    }
+    versione->cat = cat;
+    atomic_init(&versione->indice, indice);
+    return versione;
+}
+
+// Legge i file indicati e costruisce un nuovo catalogo allocato dinamicamente, completo di hash perfetto dove possibile.
+// Restituisce 0 in caso di successo oppure il codice di errore
+static int NuovoCatalogo(const char nomeFile[], const char nomeFileEsteri[], catalogo **nuovo){
+    catalogo *cat = malloc(sizeof(catalogo));
+    if(cat == NULL){
+        return ERR_ALLOCAZIONE;
+    }
+    int errore = CaricaCatalogo(cat, nomeFile, nomeFileEsteri);
+    if(errore != 0){
+        free(cat);
+        return errore;
+    }
+    // Se l'hash perfetto non può essere costruito le ricerche usano la tabella ad indirizzamento aperto
+    CostruisciHashPerfetto(cat);
+    *nuovo = cat;
+    return 0;
+}
+
+// Restituisce la versione pubblicata del catalogo, pubblicando la prima al primo utilizzo. Restituisce NULL in caso
+// di errore
+static versioneCatalogo* VersioneCondivisa(void){
+    versioneCatalogo *versione = atomic_load(&versioneAttiva);
+    if(versione != NULL){
+        return versione;
+    }
+#ifdef CATALOGO_INCORPORATO
+    // Il catalogo è già contenuto nell'eseguibile e non richiede alcuna elaborazione all'avvio
+    const catalogo *cat = &CATALOGO_COMUNI_INCORPORATO;
+#else
+    // Al primo utilizzo il file viene caricato: se più thread lo caricano contemporaneamente viene pubblicato il primo
+    // catalogo completato e gli altri vengono scartati
+    catalogo *cat;
+    if(NuovoCatalogo(FILE_CODICI_CATASTALI, FILE_CODICI_ESTERI, &cat) != 0){
+        return NULL;
+    }
+#endif
+    // L'indice dei nomi della prima versione serve solo alla ricerca approssimata e viene costruito al primo utilizzo
+    versioneCatalogo *iniziale = NuovaVersione(cat, NULL);
+    if(iniziale == NULL){
+        LiberaCatalogoPubblicato(cat);
+        return NULL;
+    }
+    if(atomic_compare_exchange_strong(&versioneAttiva, &versione, iniziale)){
+        return iniziale;
+    }
+    LiberaVersione(iniziale);
+    return versione;
+}
+
+const catalogo* CatalogoCondiviso(void){
+    versioneCatalogo *versione = VersioneCondivisa();
+    return versione != NULL ? versione->cat : NULL;
+}
+
+// Alloca una nuova posizione allineata alla linea di cache. aligned_alloc non è disponibile con tutte le librerie C
+// (MinGW, MSVC), quindi il blocco viene allocato più grande e allineato a mano: le posizioni non vengono mai liberate
+// e l'indirizzo originale non deve essere conservato. Restituisce NULL se l'allocazione fallisce
+static posizioneLettura* NuovaPosizione(void){
+    unsigned char *blocco = malloc(sizeof(posizioneLettura) + LEN_LINEA_CACHE - 1);
+    if(blocco == NULL){
+        return NULL;
+    }
+    size_t scarto = (LEN_LINEA_CACHE - (uintptr_t)blocco % LEN_LINEA_CACHE) % LEN_LINEA_CACHE;
+    return (posizioneLettura*)(blocco + scarto);
+}
+
+// Restituisce la posizione di lettura del thread chiamante, assegnandogliene una al primo utilizzo.
+// Restituisce NULL se l'allocazione fallisce
+static posizioneLettura* PosizioneThread(void){
+    posizioneLettura *posizione = posizioneThread;
+    if(posizione != NULL){
+        return posizione;
+    }
+    // Viene riutilizzata la posizione di un thread concluso, se disponibile
+    for(posizione = atomic_load(&elencoPosizioni); posizione != NULL; posizione = posizione->successiva){
+        bool occupata = false;
+        if(atomic_compare_exchange_strong(&posizione->occupata, &occupata, true)){
+            break;
+        }
+    }
+    if(posizione == NULL){
+        posizione = NuovaPosizione();
+        if(posizione == NULL){
+            return NULL;
+        }
+        atomic_init(&posizione->epoca, 0);
+        atomic_init(&posizione->occupata, true);
+        posizione->successiva = atomic_load(&elencoPosizioni);
+        while(!atomic_compare_exchange_weak(&elencoPosizioni, &posizione->successiva, posizione)){
+        }
+    }
+    posizione->annidamento = 0;
+#ifdef USA_PTHREAD
+    pthread_once(&chiavePosizioneCreata, CreaChiavePosizione);
+    pthread_setspecific(chiavePosizione, posizione);
+#endif
+    posizioneThread = posizione;
+    return posizione;
+}
+
+letturaCatalogo IniziaLetturaCatalogo(void){
+    letturaCatalogo lettura = {NULL, NULL, PosizioneThread()};
+    if(lettura.posizione == NULL){
+        return lettura;
+    }
+    // Il catalogo viene letto solo dopo aver registrato l'epoca nella posizione del thread: una ricarica che lo
+    // sostituisce in seguito attende la fine di questa lettura prima di liberarlo. Nelle letture annidate resta
+    // registrata l'epoca della più esterna, che è la più prudente
+    if(lettura.posizione->annidamento++ == 0){
+        atomic_store(&lettura.posizione->epoca, atomic_load(&epocaCorrente));
+    }
+    lettura.versione = VersioneCondivisa();
+    lettura.cat = lettura.versione != NULL ? lettura.versione->cat : NULL;
+    return lettura;
+}
+
+const indiceComuni* IndiceComuniLettura(letturaCatalogo lettura){
+    if(lettura.versione == NULL){
+        return NULL;
+    }
+    indiceComuni *indice = atomic_load(&lettura.versione->indice);
+    if(indice != NULL){
+        return indice;
+    }
+    // Se più thread costruiscono l'indice contemporaneamente viene pubblicato il primo completato. La versione non può
+    // essere liberata durante la lettura, quindi nemmeno l'indice pubblicato
+    indiceComuni *nuovo = NuovoIndice(lettura.cat);
+    if(nuovo == NULL){
+        return NULL;
+    }
+    if(atomic_compare_exchange_strong(&lettura.versione->indice, &indice, nuovo)){
+        return nuovo;
+    }
+    LiberaIndice(nuovo);
+    return indice;
+}
+
+void TerminaLetturaCatalogo(letturaCatalogo lettura){
+    if(lettura.posizione != NULL && --lettura.posizione->annidamento == 0){
+        atomic_store_explicit(&lettura.posizione->epoca, 0, memory_order_release);
+    }
+}
+
+int RicaricaCatalogo(const char nomeFile[], const char nomeFileEsteri[]){
+    // Un thread con una lettura in corso attenderebbe per sempre la conclusione della propria lettura
+    if(posizioneThread != NULL && posizioneThread->annidamento > 0){
+        return ERR_RICARICA;
+    }
+    // Il nuovo catalogo viene costruito senza interferire con le ricerche in corso sul catalogo attuale
+    // Anche l'indice dei nomi viene ricostruito prima dello scambio, in modo che catalogo e indice corrispondano sempre
+    catalogo *nuovo;
+    int errore = NuovoCatalogo(nomeFile, nomeFileEsteri, &nuovo);
+    if(errore != 0){
+        return errore;
+    }
+    indiceComuni *indice = NuovoIndice(nuovo);
+    versioneCatalogo *versione = indice != NULL ? NuovaVersione(nuovo, indice) : NULL;
+    if(versione == NULL){
+        LiberaIndice(indice);
+        LiberaCatalogoPubblicato(nuovo);
+        return ERR_ALLOCAZIONE;
+    }
+
+    while(atomic_flag_test_and_set(&ricaricaInCorso)){
+        Cedi();
+    }
+    versioneCatalogo *vecchia = atomic_exchange(&versioneAttiva, versione);
+    // Periodo di tolleranza: le letture che iniziano da questo momento registrano la nuova epoca e ottengono il nuovo
+    // catalogo, quindi basta attendere che ogni thread non abbia in corso letture registrate con un'epoca precedente
+    uint_fast64_t epoca = atomic_fetch_add(&epocaCorrente, 1) + 1;
+    for(posizioneLettura *p = atomic_load(&elencoPosizioni); p != NULL; p = p->successiva){
+        uint_fast64_t epocaLettura;
+        while((epocaLettura = atomic_load(&p->epoca)) != 0 && epocaLettura < epoca){
+            Cedi();
+        }
+    }
+    atomic_flag_clear(&ricaricaInCorso);
+
+    // Nessuna lettura può più accedere al catalogo precedente né al suo indice
+    LiberaVersione(vecchia);
+    return 0;
+}
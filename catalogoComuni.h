@@ -0,0 +1,171 @@
+#ifndef CATALOGO_COMUNI_H
+#define CATALOGO_COMUNI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* MODULO: Catalogo dei comuni italiani con i relativi codici catastali
+ * Il file codiciCatastali.csv viene letto una sola volta e indicizzato in una tabella hash ad indirizzamento aperto
+ * in modo che ogni ricerca avvenga in tempo costante e senza alcuna operazione sul file.
+ * Sui sistemi che lo consentono il file viene mappato in memoria e i nomi vengono indicizzati direttamente all'interno
+ * della mappatura, senza alcuna copia.
+ * Le ricerche per nome avvengono sulla chiave normalizzata di ogni comune (vedi NormalizzaNome), calcolata una sola
+ * volta al caricamento del catalogo: "Agliè", "aglie" e "AGLIE'" individuano quindi lo stesso comune.
+ * Ogni riga del file ha il formato "<nome>;<codice catastale>[;<sigla della provincia>]": la sigla è indicata almeno
+ * per i comuni che condividono il nome (o la chiave) con altri comuni e permette di distinguerli, ad esempio
+ * "Castro (BG)" e "Castro (LE)".
+ * Al catalogo si aggiungono gli stati esteri elencati in codiciStatiEsteri.csv, nello stesso formato e con la sigla
+ * SIGLA_ESTERO al posto della provincia: i codici "Z" dei nati all'estero vengono così cercati nelle stesse strutture
+ * dei comuni italiani.
+ * Il catalogo condiviso può essere ricaricato mentre il processo è in esecuzione (ad esempio dopo un aggiornamento
+ * ISTAT): il nuovo catalogo e l'indice dei nomi per la ricerca approssimata vengono costruiti a parte e pubblicati
+ * insieme con uno scambio atomico di puntatori, mentre quelli precedenti vengono liberati solo quando nessuna lettura
+ * li sta più utilizzando (riciclo per epoche): ogni thread registra l'epoca delle proprie letture in una posizione
+ * riservata, su una linea di cache propria, e la ricarica attende che nessuna posizione riporti un'epoca precedente
+ * allo scambio. Le ricerche non acquisiscono mai lock, non scrivono su memoria condivisa con altri thread e non
+ * attendono la ricarica.
+ */
+
+#define DIV_CHAR 59 // = ';'
+#define LEN_COD_CATASTALE 4
+#define LEN_SIGLA_PROVINCIA 2
+
+// Dimensione dell'indice per codice catastale: una lettera seguita da tre cifre (lettera * 1000 + cifre)
+#define NUM_CODICI_CATASTALI (26 * 1000)
+
+// Lunghezza massima della chiave normalizzata di un nome
+#define LEN_MAX_CHIAVE 128
+
+// Nome del file contenente l'elenco dei comuni con i relativi codici catastali
+#define FILE_CODICI_CATASTALI "codiciCatastali.csv"
+
+// Nome del file (facoltativo) contenente l'elenco degli stati esteri con i relativi codici
+#define FILE_CODICI_ESTERI "codiciStatiEsteri.csv"
+
+// Sigla che sostituisce la provincia per gli stati esteri
+#define SIGLA_ESTERO "EE"
+
+// Byte Order Mark con cui può iniziare un file di testo UTF-8
+#define BOM_UTF8 "\xEF\xBB\xBF"
+#define LEN_BOM 3
+
+typedef struct COMUNE {
+    const char *nome;               // Puntatore al nome all'interno del testo del file (non terminato da '\0')
+    uint32_t lenNome;
+    const char *chiave;             // Chiave normalizzata del nome (non terminata da '\0')
+    uint32_t lenChiave;
+    uint32_t omonimo;               // Indice + 1 del comune successivo con la stessa chiave, 0 se non ve ne sono
+    char codice[LEN_COD_CATASTALE]; // Codice catastale (non terminato da '\0')
+    char provincia[LEN_SIGLA_PROVINCIA]; // Sigla della provincia in maiuscolo (due spazi se non indicata)
+}comune;
+
+typedef struct CATALOGO {
+    const char *testo;       // Contenuto integrale del file (mappato in memoria dove possibile)
+    size_t lenTesto;
+    bool mappato;
+    const char *testoEsteri; // Contenuto del file degli stati esteri (NULL se assente)
+    size_t lenTestoEsteri;
+    bool mappatoEsteri;
+    const char *chiavi;      // Chiavi normalizzate di tutti i comuni accostate senza separatori
+    const comune *comuni;
+    uint32_t numComuni;
+    const uint32_t *tabella; // Tabella hash: contiene l'indice del comune + 1, il valore 0 indica una cella vuota
+    uint32_t maschera;       // Dimensione della tabella - 1 (la dimensione è sempre una potenza di 2)
+    // Hash perfetto minimo (se disponibile sostituisce la tabella hash): il nome viene assegnato ad un gruppo e lo
+    // spostamento del gruppo individua l'unica posizione in cui il nome può trovarsi
+    const uint32_t *spostamenti;
+    uint32_t numGruppi;
+    const uint32_t *posizioni; // Indice del comune che occupa ciascuna posizione
+    uint32_t numPosizioni;
+    const uint16_t *perCodice; // Indice inverso: indice del comune + 1 per ogni codice catastale, 0 se assente
+}catalogo;
+
+// Scrive in chiave la forma normalizzata del nome: le lettere vengono convertite in maiuscolo, le lettere accentate
+// (UTF-8) vengono sostituite dalla lettera semplice e spazi, apostrofi e trattini vengono eliminati. Restituisce la
+// lunghezza della chiave oppure 0 se la chiave è vuota o supera LEN_MAX_CHIAVE caratteri
+size_t NormalizzaNome(const char nome[], size_t lenNome, char chiave[LEN_MAX_CHIAVE]);
+
+// Calcola l'hash (FNV-1a a 64 bit) di una chiave normalizzata
+uint64_t HashChiave(const char chiave[], size_t lenChiave);
+
+// Legge l'intero file indicato, mappandolo in memoria dove possibile (mappato indica se il testo è una mappatura).
+// Il testo non è terminato da '\0'. Restituisce NULL se il file non può essere letto o, con mmap, se è vuoto
+const char* MappaFile(const char nomeFile[], size_t *lenTesto, bool *mappato);
+
+// Libera il testo di un file letto con MappaFile
+void LiberaTesto(const char testo[], size_t lenTesto, bool mappato);
+
+// Legge il file dei comuni e quello degli stati esteri (facoltativo, ignorato se NULL o assente) e costruisce il
+// catalogo. Restituisce 0 in caso di successo oppure il codice di errore
+int CaricaCatalogo(catalogo *cat, const char nomeFile[], const char nomeFileEsteri[]);
+
+// Costruisce l'hash perfetto minimo dei nomi presenti nel catalogo. Restituisce 0 in caso di successo oppure il codice
+// di errore
+int CostruisciHashPerfetto(catalogo *cat);
+
+// Cerca un comune per nome confrontando le chiavi normalizzate. Se più comuni hanno la stessa chiave (ad esempio
+// "Paterno" e "Paternò") viene preferito quello il cui nome coincide con quello cercato, altrimenti il primo presente
+// nel file. Restituisce NULL se il comune non esiste
+const comune* CercaComune(const catalogo *cat, const char nome[], size_t lenNome);
+
+// Separa dal luogo l'eventuale sigla della provincia indicata tra parentesi alla fine, come in "Castro (LE)", e la
+// scrive in maiuscolo in provincia (due spazi se assente). Restituisce la lunghezza del nome senza la sigla
+size_t SeparaProvincia(const char luogo[], size_t lenLuogo, char provincia[LEN_SIGLA_PROVINCIA]);
+
+// Cerca il comune indicato da un luogo nel formato "<nome>" oppure "<nome> (<sigla della provincia>)" senza mai
+// scegliere arbitrariamente tra comuni omonimi. Restituisce 0 e il comune in trovato, ERR_LUOGO_NASCITA se non esiste
+// alcun comune corrispondente oppure ERR_LUOGO_AMBIGUO se ve ne è più di uno: in questo caso trovato indica il primo
+// dei comuni corrispondenti, i successivi si ricavano con ProssimoOmonimo
+int CercaComuneUnivoco(const catalogo *cat, const char luogo[], size_t lenLuogo, const comune **trovato);
+
+// Restituisce il comune successivo con la stessa chiave di quello indicato oppure NULL se non ve ne sono
+const comune* ProssimoOmonimo(const catalogo *cat, const comune *c);
+
+// Cerca un comune a partire dal codice catastale. Restituisce NULL se il codice non è valido o non è presente
+const comune* CercaComunePerCodice(const catalogo *cat, const char codice[LEN_COD_CATASTALE]);
+
+// Restituisce la posizione del codice catastale all'interno dell'indice inverso oppure -1 se il codice non è valido
+int IndiceCodiceCatastale(const char codice[LEN_COD_CATASTALE]);
+
+// Libera la memoria occupata dal catalogo
+void LiberaCatalogo(catalogo *cat);
+
+// Lettura del catalogo condiviso protetta da una ricarica concorrente
+typedef struct LETTURA_CATALOGO {
+    const catalogo *cat;     // Catalogo da utilizzare (NULL in caso di errore)
+    struct VERSIONE_CATALOGO *versione;  // Versione pubblicata a cui appartiene il catalogo
+    struct POSIZIONE_LETTURA *posizione; // Posizione del thread su cui è registrata l'epoca della lettura
+}letturaCatalogo;
+
+// Restituisce il catalogo condiviso dal processo. Se l'eseguibile contiene il catalogo generato in fase di compilazione
+// (CATALOGO_INCORPORATO) viene restituito direttamente, altrimenti il file viene caricato al primo utilizzo.
+// Il catalogo restituito resta valido fino alla successiva RicaricaCatalogo: i processi che ricaricano il catalogo
+// devono accedervi con IniziaLetturaCatalogo. Restituisce NULL in caso di errore
+const catalogo* CatalogoCondiviso(void);
+
+// Inizia una lettura del catalogo condiviso: il catalogo e i suoi comuni restano validi fino alla chiamata di
+// TerminaLetturaCatalogo anche se nel frattempo viene ricaricato. Non attende mai e non acquisisce alcun lock
+letturaCatalogo IniziaLetturaCatalogo(void);
+
+// Conclude una lettura iniziata con IniziaLetturaCatalogo
+void TerminaLetturaCatalogo(letturaCatalogo lettura);
+
+// Restituisce l'indice dei nomi (vedi ricercaComuni.h) costruito sul catalogo della lettura, valido fino a
+// TerminaLetturaCatalogo: viene ricostruito da ogni ricarica e sostituito insieme al catalogo.
+// Restituisce NULL in caso di errore
+const struct INDICE_COMUNI* IndiceComuniLettura(letturaCatalogo lettura);
+
+// Costruisce un nuovo catalogo dai file indicati e lo sostituisce atomicamente a quello condiviso: le ricerche
+// successive usano il nuovo catalogo, mentre quello precedente viene liberato al termine delle letture già iniziate.
+// Non può essere chiamata tra IniziaLetturaCatalogo e TerminaLetturaCatalogo dello stesso thread: in tal caso
+// restituisce ERR_RICARICA senza attendere la fine della lettura, che non potrebbe mai concludersi.
+// In caso di errore il catalogo condiviso resta invariato. Restituisce 0 in caso di successo oppure il codice di errore
+int RicaricaCatalogo(const char nomeFile[], const char nomeFileEsteri[]);
+
+#ifdef CATALOGO_INCORPORATO
+// Catalogo generato a partire da codiciCatastali.csv e codiciStatiEsteri.csv dallo strumento generaCatalogo
+extern const catalogo CATALOGO_COMUNI_INCORPORATO;
+#endif
+
+#endif
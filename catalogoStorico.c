@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "catalogoComuni.h"
+#include "catalogoStorico.h"
+#include "codiciErrore.h"
+
+// Numero di campi di ogni riga del file: l'ultimo (la sigla della provincia) è facoltativo
+#define NUM_CAMPI_STORICO 5
+#define NUM_CAMPI_OBBLIGATORI 4
+
+uint32_t DataCompatta(int giorno, int mese, int anno){
+    return (uint32_t)anno * 10000u + (uint32_t)mese * 100u + (uint32_t)giorno;
+}
+
+// Numero di cifre di giorno, mese e anno nelle date del file
+static const int CIFRE_DATA_STORICA[3] = {2, 2, 4};
+
+// Interpreta una data nel formato "gg/mm/aaaa" (esattamente due cifre per giorno e mese e quattro per l'anno)
+// convertendola nel formato aaaammgg. Restituisce 0 se non è valida
+static uint32_t LeggiDataStorica(const char testo[], size_t len){
+    int valori[3] = {0, 0, 0}, cifre[3] = {0, 0, 0}, campo = 0;
+    for(size_t i=0; i<len; i++){
+        if(testo[i] == '/' && campo < 2){
+            campo++;
+        }
+        else if(testo[i] >= '0' && testo[i] <= '9' && cifre[campo] < CIFRE_DATA_STORICA[campo]){
+            valori[campo] = valori[campo] * 10 + (testo[i] - '0');
+            cifre[campo]++;
+        }
+        else{
+            return 0;
+        }
+    }
+    for(int i=0; i<3; i++){
+        if(cifre[i] != CIFRE_DATA_STORICA[i]){
+            return 0;
+        }
+    }
+    if(valori[0] < 1 || valori[0] > 31 || valori[1] < 1 || valori[1] > 12){
+        return 0;
+    }
+    return DataCompatta(valori[0], valori[1], valori[2]);
+}
+
+// Confronta le chiavi di due comuni in ordine lessicografico
+static int ConfrontaChiavi(const comune *a, const comune *b){
+    size_t len = a->lenChiave < b->lenChiave ? a->lenChiave : b->lenChiave;
+    int confronto = memcmp(a->chiave, b->chiave, len);
+    if(confronto != 0){
+        return confronto;
+    }
+    return (a->lenChiave > b->lenChiave) - (a->lenChiave < b->lenChiave);
+}
+
+// Ordina i periodi per chiave, a parità di chiave per sigla della provincia e infine per data di inizio
+static int ConfrontaPeriodi(const void *a, const void *b){
+    const periodoComune *p = a, *q = b;
+    int confronto = ConfrontaChiavi(&p->comune, &q->comune);
+    if(confronto != 0){
+        return confronto;
+    }
+    confronto = memcmp(p->comune.provincia, q->comune.provincia, LEN_SIGLA_PROVINCIA);
+    if(confronto != 0){
+        return confronto;
+    }
+    return (p->dal > q->dal) - (p->dal < q->dal);
+}
+
+// Scrive in maiuscolo la sigla della provincia indicata nel file (due spazi se il campo è vuoto).
+// Restituisce false se il campo non è vuoto e non è composto da due lettere
+static bool LeggiSiglaStorica(const char testo[], size_t len, char provincia[LEN_SIGLA_PROVINCIA]){
+    memset(provincia, ' ', LEN_SIGLA_PROVINCIA);
+    if(len == 0){
+        return true;
+    }
+    if(len != LEN_SIGLA_PROVINCIA){
+        return false;
+    }
+    for(int i=0; i<LEN_SIGLA_PROVINCIA; i++){
+        char c = (char)(testo[i] & ~0x20);
+        if(c < 'A' || c > 'Z'){
+            memset(provincia, ' ', LEN_SIGLA_PROVINCIA);
+            return false;
+        }
+        provincia[i] = c;
+    }
+    return true;
+}
+
+int CaricaCatalogoStorico(catalogoStorico *cat, const char nomeFile[]){
+    // Il file viene letto come quello dei comuni: mappato in memoria dove possibile e senza l'eventuale BOM UTF-8
+    memset(cat, 0, sizeof(*cat));
+    cat->testo = MappaFile(nomeFile, &cat->lenTesto, &cat->mappato);
+    if(cat->testo == NULL){
+        return ERR_CATALOGO;
+    }
+    const char *riga = cat->testo, *fine = cat->testo + cat->lenTesto;
+    if(cat->lenTesto >= LEN_BOM && memcmp(riga, BOM_UTF8, LEN_BOM) == 0){
+        riga += LEN_BOM;
+    }
+
+    uint32_t numRighe = 1;
+    for(size_t i=0; i<cat->lenTesto; i++){
+        if(cat->testo[i] == '\n'){
+            numRighe++;
+        }
+    }
+    cat->periodi = malloc(numRighe * sizeof(periodoComune));
+    cat->chiavi = malloc(cat->lenTesto + 1);
+    if(cat->periodi == NULL || cat->chiavi == NULL){
+        LiberaCatalogoStorico(cat);
+        return ERR_ALLOCAZIONE;
+    }
+
+    // Ogni riga valida produce un periodo: le righe con campi mancanti o date non valide vengono ignorate
+    size_t lenChiavi = 0;
+    while(riga < fine){
+        const char *fineRiga = memchr(riga, '\n', (size_t)(fine - riga));
+        if(fineRiga == NULL){
+            fineRiga = fine;
+        }
+        size_t lenRiga = (size_t)(fineRiga - riga);
+        if(lenRiga > 0 && riga[lenRiga - 1] == '\r'){
+            lenRiga--;
+        }
+
+        const char *campi[NUM_CAMPI_STORICO];
+        size_t lenCampi[NUM_CAMPI_STORICO];
+        int numCampi = 0;
+        const char *inizio = riga;
+        for(size_t i=0; i<=lenRiga && numCampi < NUM_CAMPI_STORICO; i++){
+            if(i == lenRiga || riga[i] == DIV_CHAR){
+                campi[numCampi] = inizio;
+                lenCampi[numCampi++] = (size_t)(riga + i - inizio);
+                inizio = riga + i + 1;
+            }
+        }
+
+        if(numCampi < NUM_CAMPI_STORICO){
+            lenCampi[NUM_CAMPI_STORICO - 1] = 0;
+            campi[NUM_CAMPI_STORICO - 1] = riga + lenRiga;
+        }
+        if(numCampi >= NUM_CAMPI_OBBLIGATORI && lenCampi[0] > 0 && lenCampi[1] == LEN_COD_CATASTALE
+           && IndiceCodiceCatastale(campi[1]) >= 0){
+            periodoComune *p = &cat->periodi[cat->numPeriodi];
+            p->dal = LeggiDataStorica(campi[2], lenCampi[2]);
+            p->al = lenCampi[3] == 0 ? DATA_FINE_VALIDITA : LeggiDataStorica(campi[3], lenCampi[3]);
+            p->comune.nome = campi[0];
+            p->comune.lenNome = (uint32_t)lenCampi[0];
+            p->comune.chiave = cat->chiavi + lenChiavi;
+            p->comune.lenChiave = (uint32_t)NormalizzaNome(campi[0], lenCampi[0], cat->chiavi + lenChiavi);
+            p->comune.omonimo = 0;
+            memcpy(p->comune.codice, campi[1], LEN_COD_CATASTALE);
+            bool siglaValida = LeggiSiglaStorica(campi[4], lenCampi[4], p->comune.provincia);
+            if(p->dal != 0 && p->al != 0 && p->dal <= p->al && p->comune.lenChiave > 0 && siglaValida){
+                lenChiavi += p->comune.lenChiave;
+                cat->numPeriodi++;
+            }
+        }
+        riga = fineRiga + 1;
+    }
+    qsort(cat->periodi, cat->numPeriodi, sizeof(periodoComune), ConfrontaPeriodi);
+
+    // Raggruppo i periodi consecutivi con la stessa chiave e indicizzo ogni nome nella tabella hash
+    uint32_t dimensione = 16;
+    while(dimensione < cat->numPeriodi * 2){
+        dimensione <<= 1;
+    }
+    cat->nomi = malloc((cat->numPeriodi + 1) * sizeof(nomeStorico));
+    cat->tabella = calloc(dimensione, sizeof(uint32_t));
+    cat->perCodice = calloc(NUM_CODICI_CATASTALI, sizeof(uint32_t));
+    if(cat->nomi == NULL || cat->tabella == NULL || cat->perCodice == NULL){
+        LiberaCatalogoStorico(cat);
+        return ERR_ALLOCAZIONE;
+    }
+    cat->maschera = dimensione - 1;
+    for(uint32_t i=0; i<cat->numPeriodi; i++){
+        const comune *c = &cat->periodi[i].comune;
+        if(i == 0 || ConfrontaChiavi(c, &cat->periodi[i - 1].comune) != 0){
+            cat->nomi[cat->numNomi++] = (nomeStorico){i, 0};
+            uint32_t pos = (uint32_t)HashChiave(c->chiave, c->lenChiave) & cat->maschera;
+            while(cat->tabella[pos] != 0){
+                pos = (pos + 1) & cat->maschera;
+            }
+            cat->tabella[pos] = cat->numNomi;
+        }
+        cat->nomi[cat->numNomi - 1].numPeriodi++;
+
+        int indice = IndiceCodiceCatastale(c->codice);
+        if(cat->perCodice[indice] == 0){
+            cat->perCodice[indice] = i + 1;
+        }
+    }
+    return 0;
+}
+
+// Restituisce il periodo in vigore alla data indicata tra i periodi (ordinati per data di inizio) di un nome e di una
+// provincia, oppure NULL se nessun periodo contiene la data
+static const periodoComune* PeriodoInVigore(const periodoComune periodi[], uint32_t numPeriodi, uint32_t data){
+    // Ricerca binaria dell'ultimo periodo iniziato non dopo la data indicata
+    uint32_t basso = 0, alto = numPeriodi;
+    while(basso < alto){
+        uint32_t medio = basso + (alto - basso) / 2;
+        if(periodi[medio].dal <= data){
+            basso = medio + 1;
+        }
+        else{
+            alto = medio;
+        }
+    }
+    if(basso == 0 || periodi[basso - 1].al < data){
+        return NULL;
+    }
+    return &periodi[basso - 1];
+}
+
+int CercaComuneStorico(const catalogoStorico *cat, const char luogo[], size_t lenLuogo, uint32_t data,
+                       const comune **trovato){
+    char provincia[LEN_SIGLA_PROVINCIA], chiave[LEN_MAX_CHIAVE];
+    size_t lenNome = SeparaProvincia(luogo, lenLuogo, provincia);
+    size_t lenChiave = NormalizzaNome(luogo, lenNome, chiave);
+    bool conProvincia = provincia[0] != ' ';
+    *trovato = NULL;
+    if(lenChiave == 0 || cat->numNomi == 0){
+        return ERR_LUOGO_NASCITA;
+    }
+
+    uint32_t pos = (uint32_t)HashChiave(chiave, lenChiave) & cat->maschera;
+    while(cat->tabella[pos] != 0){
+        const nomeStorico *n = &cat->nomi[cat->tabella[pos] - 1];
+        const periodoComune *periodi = &cat->periodi[n->primo];
+        if(periodi[0].comune.lenChiave == lenChiave && memcmp(periodi[0].comune.chiave, chiave, lenChiave) == 0){
+            // I periodi del nome sono raggruppati per provincia: in ogni gruppo (della provincia indicata, se presente)
+            // si cerca il periodo in vigore alla data. Se la provincia non è indicata e il nome era in vigore in più
+            // province il luogo è ambiguo, come per i comuni omonimi del catalogo attuale
+            int numCandidati = 0;
+            uint32_t inizio = 0;
+            while(inizio < n->numPeriodi){
+                uint32_t fine = inizio + 1;
+                while(fine < n->numPeriodi && memcmp(periodi[fine].comune.provincia, periodi[inizio].comune.provincia,
+                                                     LEN_SIGLA_PROVINCIA) == 0){
+                    fine++;
+                }
+                if(!conProvincia || memcmp(periodi[inizio].comune.provincia, provincia, LEN_SIGLA_PROVINCIA) == 0){
+                    const periodoComune *periodo = PeriodoInVigore(periodi + inizio, fine - inizio, data);
+                    if(periodo != NULL && numCandidati++ == 0){
+                        *trovato = &periodo->comune;
+                    }
+                }
+                inizio = fine;
+            }
+            if(numCandidati == 0){
+                return ERR_LUOGO_NASCITA;
+            }
+            return numCandidati > 1 ? ERR_LUOGO_AMBIGUO : 0;
+        }
+        pos = (pos + 1) & cat->maschera;
+    }
+    return ERR_LUOGO_NASCITA;
+}
+
+const comune* CercaComuneStoricoPerCodice(const catalogoStorico *cat, const char codice[LEN_COD_CATASTALE]){
+    int indice = IndiceCodiceCatastale(codice);
+    if(indice < 0 || cat->perCodice[indice] == 0){
+        return NULL;
+    }
+    return &cat->periodi[cat->perCodice[indice] - 1].comune;
+}
+
+void LiberaCatalogoStorico(catalogoStorico *cat){
+    LiberaTesto(cat->testo, cat->lenTesto, cat->mappato);
+    free(cat->chiavi);
+    free(cat->periodi);
+    free(cat->nomi);
+    free(cat->tabella);
+    free(cat->perCodice);
+    memset(cat, 0, sizeof(*cat));
+}
+
+// Catalogo storico condiviso, pubblicato con uno scambio atomico al primo utilizzo. Se il file non è disponibile viene
+// pubblicato il catalogo vuoto, in modo che il file venga cercato una sola volta per tutto il processo
+static const catalogoStorico CATALOGO_STORICO_ASSENTE;
+static _Atomic(const catalogoStorico*) storicoCondiviso;
+
+const catalogoStorico* CatalogoStoricoCondiviso(void){
+    const catalogoStorico *cat = atomic_load(&storicoCondiviso);
+    if(cat == NULL){
+        // Se più thread caricano il file contemporaneamente viene pubblicato il primo catalogo completato e gli altri
+        // vengono scartati
+        const catalogoStorico *caricato = &CATALOGO_STORICO_ASSENTE;
+        catalogoStorico *nuovo = malloc(sizeof(catalogoStorico));
+        if(nuovo != NULL && CaricaCatalogoStorico(nuovo, FILE_CODICI_STORICI) == 0){
+            caricato = nuovo;
+        }
+        else{
+            free(nuovo);
+            nuovo = NULL;
+        }
+        if(atomic_compare_exchange_strong(&storicoCondiviso, &cat, caricato)){
+            cat = caricato;
+        }
+        else if(nuovo != NULL){
+            LiberaCatalogoStorico(nuovo);
+            free(nuovo);
+        }
+    }
+    return cat != &CATALOGO_STORICO_ASSENTE ? cat : NULL;
+}
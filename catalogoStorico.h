@@ -0,0 +1,76 @@
+#ifndef CATALOGO_STORICO_H
+#define CATALOGO_STORICO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "catalogoComuni.h"
+
+/* MODULO: Catalogo storico dei comuni con i periodi di validità dei codici catastali
+ * I comuni soppressi, fusi o rinominati non compaiono più nell'elenco attuale dei comuni, ma i codici fiscali delle
+ * persone nate quando erano in vigore ne contengono comunque il codice catastale. Il file codiciCatastaliStorici.csv
+ * (facoltativo) contiene una riga "<nome>;<codice catastale>;<dal gg/mm/aaaa>;<al gg/mm/aaaa>[;<sigla della provincia>]"
+ * per ogni periodo in cui un nome è stato associato ad un codice; la data finale vuota indica un periodo ancora in
+ * corso. Come nel catalogo attuale, la sigla distingue i comuni omonimi di province diverse.
+ * I periodi di ogni nome vengono ordinati per provincia e per data di inizio: il nome viene individuato con una tabella
+ * hash sulla chiave normalizzata e il periodo che contiene una data con una ricerca binaria tra i periodi del nome
+ * nella stessa provincia.
+ * Le date sono rappresentate come numeri nel formato aaaammgg, direttamente confrontabili.
+ */
+
+// Nome del file contenente lo storico dei codici catastali
+#define FILE_CODICI_STORICI "codiciCatastaliStorici.csv"
+
+// Data finale dei periodi ancora in corso
+#define DATA_FINE_VALIDITA 99991231u
+
+typedef struct PERIODO_COMUNE {
+    comune comune;         // Nome e codice catastale in vigore nel periodo
+    uint32_t dal;          // Primo giorno di validità (aaaammgg)
+    uint32_t al;           // Ultimo giorno di validità (aaaammgg)
+}periodoComune;
+
+typedef struct NOME_STORICO {
+    uint32_t primo;        // Indice del primo periodo del nome (i periodi del nome sono consecutivi e ordinati)
+    uint32_t numPeriodi;
+}nomeStorico;
+
+typedef struct CATALOGO_STORICO {
+    const char *testo;         // Contenuto integrale del file (mappato in memoria dove possibile)
+    size_t lenTesto;
+    bool mappato;
+    char *chiavi;              // Chiavi normalizzate dei nomi accostate senza separatori
+    periodoComune *periodi;
+    uint32_t numPeriodi;
+    nomeStorico *nomi;
+    uint32_t numNomi;
+    uint32_t *tabella;         // Tabella hash dei nomi: indice del nome + 1, 0 per le celle vuote
+    uint32_t maschera;
+    uint32_t *perCodice;       // Indice del periodo + 1 per ogni codice catastale, 0 se assente
+}catalogoStorico;
+
+// Converte una data nel formato aaaammgg
+uint32_t DataCompatta(int giorno, int mese, int anno);
+
+// Legge il file indicato e costruisce il catalogo storico. Restituisce 0 in caso di successo oppure il codice di errore
+int CaricaCatalogoStorico(catalogoStorico *cat, const char nomeFile[]);
+
+// Cerca il comune indicato da un luogo nel formato "<nome>" oppure "<nome> (<sigla della provincia>)" in vigore alla
+// data indicata (aaaammgg), senza mai scegliere arbitrariamente tra comuni omonimi. Restituisce 0 e il comune in
+// trovato, ERR_LUOGO_NASCITA se nessun comune corrispondente era in vigore alla data oppure ERR_LUOGO_AMBIGUO se la
+// provincia non è indicata e ve ne era più di uno
+int CercaComuneStorico(const catalogoStorico *cat, const char luogo[], size_t lenLuogo, uint32_t data,
+                       const comune **trovato);
+
+// Cerca un comune del catalogo storico a partire dal codice catastale. Restituisce NULL se il codice non è presente
+const comune* CercaComuneStoricoPerCodice(const catalogoStorico *cat, const char codice[LEN_COD_CATASTALE]);
+
+// Libera la memoria occupata dal catalogo storico
+void LiberaCatalogoStorico(catalogoStorico *cat);
+
+// Restituisce il catalogo storico condiviso dal processo, caricato al primo utilizzo. Restituisce NULL se il file non è
+// disponibile: il catalogo storico è facoltativo e la sua assenza non è un errore. Può essere chiamata da più thread
+const catalogoStorico* CatalogoStoricoCondiviso(void);
+
+#endif
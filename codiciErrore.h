@@ -0,0 +1,29 @@
+#ifndef CODICI_ERRORE_H
+#define CODICI_ERRORE_H
+
+/* ELENCO CODICI ERRORE RESTITUITI:
+ *      0 - Esecuzione conclusa con successo;
+ *      1 - Errore nell'allocazione dinamica;
+ *      2 - Luogo di nascita non presente nel file codiciCatastali.csv
+ *      3 - File codiciCatastali.csv non disponibile
+ *      4 - Dati del soggetto non validi (modalità batch, riportato per la singola riga)
+ *      5 - File di input non disponibile (modalità batch)
+ *      6 - File di uscita non scrivibile (strumenti di generazione)
+ *      7 - Luogo di nascita ambiguo: più comuni con lo stesso nome, è necessario indicare la provincia
+ *      8 - Impossibile avviare il servizio (socket non disponibile o sistema non supportato)
+ *      9 - Impossibile creare i thread dell'elaborazione parallela (modalità batch)
+ *     10 - Ricarica del catalogo richiesta da un thread che lo sta leggendo
+ */
+
+#define ERR_ALLOCAZIONE 1
+#define ERR_LUOGO_NASCITA 2
+#define ERR_CATALOGO 3
+#define ERR_DATI 4
+#define ERR_FILE_INPUT 5
+#define ERR_FILE_USCITA 6
+#define ERR_LUOGO_AMBIGUO 7
+#define ERR_SERVER 8
+#define ERR_THREAD 9
+#define ERR_RICARICA 10
+
+#endif
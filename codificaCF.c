@@ -0,0 +1,809 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "catalogoComuni.h"
+#include "catalogoStorico.h"
+#include "codiciErrore.h"
+#include "codificaCF.h"
+#include "strumentazione.h"
+
+// Campi di una riga nel formato della codifica, separati da DIV_CHAR oppure da SEP_TAB
+#define NUM_CAMPI_PERSONA 5
+#define SEP_TAB '\t'
+
+// Numero massimo di cifre di giorno, mese e anno nella data di nascita
+#define CIFRE_GIORNO 2
+#define CIFRE_MESE 2
+#define CIFRE_ANNO 4
+
+// Le istruzioni vettoriali vengono usate solo se il compilatore le rende disponibili per l'architettura di destinazione:
+// SSE2 per il controllo dei caratteri, SSSE3 anche per il calcolo del carattere di controllo. Se SSSE3 non è garantito
+// dalle opzioni di compilazione (GCC e Clang), la relativa versione viene compilata a parte e usata solo se il
+// processore su cui il programma viene eseguito la supporta
+#if defined(__SSE2__)
+#define USA_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#define USA_SSSE3
+#include <tmmintrin.h>
+#elif defined(__SSE2__) && defined(__GNUC__)
+#define USA_SSSE3
+#define SCELTA_SSSE3
+#include <tmmintrin.h>
+#endif
+
+// Lettere corrispondenti ai mesi per la codifica della data di nascita
+const char MESI[NUM_MESI + 1] = "_ABCDEHLMPRST";
+
+// Alfabeto per la determinazione del CIN: per ogni carattere sono riportati il valore assunto in posizione dispari
+// e il valore assunto in posizione pari. Da questo elenco vengono generate tutte le tabelle sottostanti
+#define ALFABETO_CIN(X) \
+    X('0', 1, 0) X('1', 0, 1) X('2', 5, 2) X('3', 7, 3) X('4', 9, 4) X('5', 13, 5) \
+    X('6', 15, 6) X('7', 17, 7) X('8', 19, 8) X('9', 21, 9) X('A', 1, 0) X('B', 0, 1) \
+    X('C', 5, 2) X('D', 7, 3) X('E', 9, 4) X('F', 13, 5) X('G', 15, 6) X('H', 17, 7) \
+    X('I', 19, 8) X('J', 21, 9) X('K', 2, 10) X('L', 4, 11) X('M', 18, 12) X('N', 20, 13) \
+    X('O', 11, 14) X('P', 3, 15) X('Q', 6, 16) X('R', 8, 17) X('S', 12, 18) X('T', 14, 19) \
+    X('U', 16, 20) X('V', 10, 21) X('W', 22, 22) X('X', 25, 23) X('Y', 24, 24) X('Z', 23, 25)
+
+#define CARATTERE_CIN(c, dispari, pari) c,
+#define DISPARI_CIN(c, dispari, pari) dispari,
+#define PARI_CIN(c, dispari, pari) pari,
+#define DISPARI_CIN_ASCII(c, dispari, pari) [(unsigned char)(c)] = (dispari),
+#define PARI_CIN_ASCII(c, dispari, pari) [(unsigned char)(c)] = (pari),
+
+// Alfabeti per la determinazione del CIN
+const char CARATTERI[36] = {ALFABETO_CIN(CARATTERE_CIN)};
+const int VALORE_CARATTERI_DISPARI[36] = {ALFABETO_CIN(DISPARI_CIN)};
+const int VALORE_CARATTERI_PARI[36] = {ALFABETO_CIN(PARI_CIN)};
+const char CARATTERI_RESTO[26] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const char CIFRE_OMOCODIA[10] = {'L', 'M', 'N', 'P', 'Q', 'R', 'S', 'T', 'U', 'V'};
+const unsigned char POSIZIONI_OMOCODIA[NUM_POSIZIONI_OMOCODIA] = {14, 13, 12, 10, 9, 7, 6};
+
+// Numero del mese corrispondente ad ogni lettera (inverso di MESI), 0 per le lettere che non indicano un mese
+static const unsigned char MESE_DA_LETTERA[256] = {
+    ['A'] = 1, ['B'] = 2, ['C'] = 3, ['D'] = 4, ['E'] = 5, ['H'] = 6,
+    ['L'] = 7, ['M'] = 8, ['P'] = 9, ['R'] = 10, ['S'] = 11, ['T'] = 12
+};
+
+// Valore + 1 delle cifre e delle lettere che le sostituiscono in caso di omocodia (LMNPQRSTUV), 0 per gli altri byte
+#define VALORE_OMOCODIA(c, cifra) [(unsigned char)(c)] = (cifra) + 1, ['0' + (cifra)] = (cifra) + 1
+static const unsigned char VALORE_CIFRA[256] = {
+    VALORE_OMOCODIA('L', 0), VALORE_OMOCODIA('M', 1), VALORE_OMOCODIA('N', 2), VALORE_OMOCODIA('P', 3),
+    VALORE_OMOCODIA('Q', 4), VALORE_OMOCODIA('R', 5), VALORE_OMOCODIA('S', 6), VALORE_OMOCODIA('T', 7),
+    VALORE_OMOCODIA('U', 8), VALORE_OMOCODIA('V', 9)
+};
+
+// Restituisce il valore di una cifra (o della lettera di omocodia corrispondente) oppure -1 se il carattere non lo è
+static inline int ValoreCifra(char c){
+    return VALORE_CIFRA[(unsigned char)c] - 1;
+}
+
+#ifndef USA_SSE2
+// Classi di caratteri ammesse nelle posizioni del codice fiscale
+#define CLASSE_LETTERA 1
+#define CLASSE_CIFRA 2
+static const unsigned char CLASSE_CARATTERE[256] = {
+    ['A'] = CLASSE_LETTERA, ['B'] = CLASSE_LETTERA, ['C'] = CLASSE_LETTERA, ['D'] = CLASSE_LETTERA,
+    ['E'] = CLASSE_LETTERA, ['F'] = CLASSE_LETTERA, ['G'] = CLASSE_LETTERA, ['H'] = CLASSE_LETTERA,
+    ['I'] = CLASSE_LETTERA, ['J'] = CLASSE_LETTERA, ['K'] = CLASSE_LETTERA, ['O'] = CLASSE_LETTERA,
+    ['W'] = CLASSE_LETTERA, ['X'] = CLASSE_LETTERA, ['Y'] = CLASSE_LETTERA, ['Z'] = CLASSE_LETTERA,
+    // Le lettere di omocodia sono ammesse anche al posto delle cifre
+    ['L'] = CLASSE_LETTERA | CLASSE_CIFRA, ['M'] = CLASSE_LETTERA | CLASSE_CIFRA, ['N'] = CLASSE_LETTERA | CLASSE_CIFRA,
+    ['P'] = CLASSE_LETTERA | CLASSE_CIFRA, ['Q'] = CLASSE_LETTERA | CLASSE_CIFRA, ['R'] = CLASSE_LETTERA | CLASSE_CIFRA,
+    ['S'] = CLASSE_LETTERA | CLASSE_CIFRA, ['T'] = CLASSE_LETTERA | CLASSE_CIFRA, ['U'] = CLASSE_LETTERA | CLASSE_CIFRA,
+    ['V'] = CLASSE_LETTERA | CLASSE_CIFRA,
+    ['0'] = CLASSE_CIFRA, ['1'] = CLASSE_CIFRA, ['2'] = CLASSE_CIFRA, ['3'] = CLASSE_CIFRA, ['4'] = CLASSE_CIFRA,
+    ['5'] = CLASSE_CIFRA, ['6'] = CLASSE_CIFRA, ['7'] = CLASSE_CIFRA, ['8'] = CLASSE_CIFRA, ['9'] = CLASSE_CIFRA
+};
+static const unsigned char CLASSE_POSIZIONE[LEN_CF] = {
+    CLASSE_LETTERA, CLASSE_LETTERA, CLASSE_LETTERA, CLASSE_LETTERA, CLASSE_LETTERA, CLASSE_LETTERA,
+    CLASSE_CIFRA, CLASSE_CIFRA, CLASSE_LETTERA, CLASSE_CIFRA, CLASSE_CIFRA,
+    CLASSE_LETTERA, CLASSE_CIFRA, CLASSE_CIFRA, CLASSE_CIFRA, CLASSE_LETTERA
+};
+#else
+// Maschera delle posizioni che contengono lettere (0xFF) e di quelle che contengono cifre (0x00)
+static const unsigned char POSIZIONI_LETTERE[LEN_CF] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0,
+                                                        0xFF};
+#endif
+
+#ifdef USA_SSSE3
+// Valori in posizione dispari per indici da 0 a 15 (cifre e lettere A-P) e da 16 a 25 (lettere Q-Z), ricavati da
+// VALORE_CARATTERI_DISPARI. Le maschere selezionano le posizioni dispari (1a, 3a, ..., 15a) e i 15 caratteri che
+// concorrono al calcolo
+static const unsigned char DISPARI_BASSI[16] = {1, 0, 5, 7, 9, 13, 15, 17, 19, 21, 2, 4, 18, 20, 11, 3};
+static const unsigned char DISPARI_ALTI[16] = {6, 8, 12, 14, 16, 10, 22, 25, 24, 23};
+static const unsigned char POSIZIONI_DISPARI[LEN_CF] = {0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0,
+                                                        0xFF, 0};
+static const unsigned char POSIZIONI_CIN[LEN_CF] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                                    0xFF, 0xFF, 0xFF, 0xFF, 0};
+#endif
+
+// Descrizione degli esiti della validazione di un codice fiscale
+const char *const DESCRIZIONE_ESITO_CF[NUM_ESITI_CF] = {
+    "Codice fiscale valido",
+    "Lunghezza errata",
+    "Carattere non ammesso nella posizione",
+    "Lettera del mese non valida",
+    "Giorno di nascita non valido",
+    "Codice catastale non presente nel catalogo",
+    "Carattere di controllo errato"
+};
+
+// Valore di ogni byte in base alla posizione: la riga 0 si riferisce alle posizioni dispari (1a, 3a, ...), la riga 1
+// alle posizioni pari. I caratteri che non appartengono all'alfabeto valgono 0 e quindi non incidono sul calcolo
+static const unsigned char VALORE_CIN[2][256] = {
+    {ALFABETO_CIN(DISPARI_CIN_ASCII)},
+    {ALFABETO_CIN(PARI_CIN_ASCII)}
+};
+
+// Controlla se il carattere passato come parametro è una vocale italiana (secondo tabella ASCII standard)
+bool IsVocale(char c){
+    if(c == 'a' || c == 'A' || c == 'e' || c == 'E' || c == 'i' || c == 'I' || c == 'o' || c == 'O' || c == 'u' || c == 'U'){
+        return true;
+    }
+    else{
+        return false;
+    }
+}
+
+// Conta le consonanti in una stringa passata come parametro
+int ContaConsonanti(const char parola[]) {
+    int cont = 0;
+    for(int i=0; parola[i] != '\0'; i++) {
+        if(!IsVocale(parola[i])) {
+            cont++;
+        }
+    }
+    return cont;
+}
+
+// Controlla che la stringa passata come parametro sia considerabile un nome italiano
+bool ValidaNome(const char nome[]){
+    int i;
+    for(i=0; nome[i] != '\0'; i++){
+        if(!isalpha((unsigned char)nome[i])) {
+            return false;
+        }
+    }
+    return i >= LEN_MIN_NOME;
+}
+
+// Controlla che la stringa passata come parametro sia considerabile un cognome italiano
+bool ValidaCognome(const char cognome[]){
+    int i;
+    for(i=0; cognome[i] != '\0'; i++){
+        if(!isalpha((unsigned char)cognome[i])) {
+            return false;
+        }
+    }
+    return i >= LEN_MIN_COGNOME;
+}
+
+// Controlla che la stringa passata come parametro sia considerabile un comune italiano
+bool ValidaLuogoNascita(const char luogoNascita[]){
+    // Sono ammessi lettere (anche accentate), spazi, apostrofi e trattini seguiti dall'eventuale sigla della provincia
+    // tra parentesi: la validità viene quindi verificata sulla chiave normalizzata del nome, che deve contenere solo
+    // lettere maiuscole o byte UTF-8
+    char chiave[LEN_MAX_CHIAVE], provincia[LEN_SIGLA_PROVINCIA];
+    size_t len = NormalizzaNome(luogoNascita, SeparaProvincia(luogoNascita, strlen(luogoNascita), provincia), chiave);
+    for(size_t i=0; i<len; i++){
+        if(!isupper((unsigned char)chiave[i]) && (unsigned char)chiave[i] < 0x80){
+            return false;
+        }
+    }
+    return len >= LEN_MIN_LUOGO_NASCITA;
+}
+
+// Restituisce il numero di giorni del mese specificato tenendo conto degli anni bisestili
+int GiorniNelMese(int mese, int anno){
+    bool bisestile;
+    // Controllo se l'anno sia bisestile o non bisestile
+    if(anno % 100 == 0){
+        bisestile = anno % 400 == 0;
+    }
+    else{
+        bisestile = anno % 4 == 0;
+    }
+
+    if(mese == 2){
+        if(bisestile){
+            return 29;
+        }
+        else{
+            return 28;
+        }
+    }
+    else if(mese == 4 || mese == 6 || mese == 9 || mese == 11){
+        return 30;
+    }
+    else{
+        return 31;
+    }
+}
+
+// Controlla che la data passata come parametro sia una data di nascita valida
+bool ValidaData(data data){
+    if(data.anno < ANNO_MIN || data.mese < 1 || data.mese > NUM_MESI){
+        return false;
+    }
+    return data.giorno >= 1 && data.giorno <= GiorniNelMese(data.mese, data.anno);
+}
+
+// Lettere significative di un nome o di un cognome raccolte durante la codifica
+typedef struct LETTERE {
+    char consonanti[LEN_COD_NOME + 1];
+    char vocali[LEN_COD_NOME];
+    int numConsonanti;
+    int numVocali;
+}lettere;
+
+// Raccoglie in un'unica scansione della parola le prime consonanti e le prime vocali (convertite in maiuscolo)
+// e conta il numero totale di consonanti presenti
+static void ClassificaLettere(const char parola[], lettere *lettere){
+    lettere->numConsonanti = 0;
+    lettere->numVocali = 0;
+    for(const char *c = parola; *c != '\0'; c++){
+        if(!isalpha((unsigned char)*c)){
+            continue;
+        }
+        char lettera = (char)toupper((unsigned char)*c);
+        if(IsVocale(lettera)){
+            if(lettere->numVocali < LEN_COD_NOME){
+                lettere->vocali[lettere->numVocali] = lettera;
+            }
+            lettere->numVocali++;
+        }
+        else{
+            if(lettere->numConsonanti < LEN_COD_NOME + 1){
+                lettere->consonanti[lettere->numConsonanti] = lettera;
+            }
+            lettere->numConsonanti++;
+        }
+    }
+}
+
+// Completa la codifica a partire dalla posizione indicata aggiungendo prima le vocali e poi il carattere di riempimento
+static void CompletaCodifica(const lettere *lettere, int pos, char codifica[LEN_COD_NOME]){
+    for(int i=0; pos < LEN_COD_NOME && i < lettere->numVocali; i++){
+        codifica[pos++] = lettere->vocali[i];
+    }
+    while(pos < LEN_COD_NOME){
+        codifica[pos++] = 'X';
+    }
+}
+
+// Scrive la codifica del nome della persona nel buffer passato come parametro (senza terminatore)
+static void ScriviCodificaNome(const char nome[], char codNome[LEN_COD_NOME]) {
+    lettere lettere;
+    ClassificaLettere(nome, &lettere);
+
+    if(lettere.numConsonanti >= 4){
+        // Se il numero di consonanti è maggiore o uguale a 4 si prelevano la prima, la terza e la quarta
+        codNome[0] = lettere.consonanti[0];
+        codNome[1] = lettere.consonanti[2];
+        codNome[2] = lettere.consonanti[3];
+    }
+    else{
+        // Altrimenti si prelevano tutte le consonanti e si completa la codifica con le vocali
+        for(int i=0; i<lettere.numConsonanti; i++){
+            codNome[i] = lettere.consonanti[i];
+        }
+        CompletaCodifica(&lettere, lettere.numConsonanti, codNome);
+    }
+}
+
+// Scrive la codifica del cognome della persona nel buffer passato come parametro (senza terminatore)
+static void ScriviCodificaCognome(const char cognome[], char codCognome[LEN_COD_COGNOME]) {
+    lettere lettere;
+    ClassificaLettere(cognome, &lettere);
+
+    // Si prelevano le prime tre consonanti e si completa l'eventuale codifica incompleta con le vocali
+    int numConsonanti = lettere.numConsonanti < LEN_COD_COGNOME ? lettere.numConsonanti : LEN_COD_COGNOME;
+    for(int i=0; i<numConsonanti; i++){
+        codCognome[i] = lettere.consonanti[i];
+    }
+    CompletaCodifica(&lettere, numConsonanti, codCognome);
+}
+
+// Scrive la codifica della data di nascita della persona nel buffer passato come parametro (senza terminatore)
+static void ScriviCodificaDataNascita(data data, char sesso, char codificaData[LEN_COD_DN]){
+    // Dell'anno di nascita vengono considerate solo le ultime due cifre
+    codificaData[0] = (char)('0' + data.anno / 10 % 10);
+    codificaData[1] = (char)('0' + data.anno % 10);
+
+    // Recupero la lettera associata al mese dall'aposito alfabeto
+    codificaData[2] = MESI[data.mese];
+
+    // I giorni di nascita per i soggetti femminili figurano da 41 a 71, quelli dei soggetti maschili figurano invariati
+    // da 1 a 31: in entrambi i casi vengono scritti nel formato "GG"
+    if(sesso == 'F'){
+        data.giorno += 40;
+    }
+    codificaData[3] = (char)('0' + data.giorno / 10);
+    codificaData[4] = (char)('0' + data.giorno % 10);
+}
+
+// Calcola il CIN partendo dal codice fiscale parziale
+char CalcolaCIN(char codiceFiscaleParziale[]){
+    int resto = 0;
+    for(int i=0; codiceFiscaleParziale[i] != '\0'; i++){
+        // Il valore di ogni carattere dipende unicamente dal carattere stesso e dalla parità della sua posizione
+        resto += VALORE_CIN[i & 1][(unsigned char)codiceFiscaleParziale[i]];
+    }
+    // Restituisco il carattere corrispondendente al resto della divisione per 26
+    return CARATTERI_RESTO[resto % 26];
+}
+
+char CalcolaCarattereControllo(const char codiceParziale[LEN_CF - 1]){
+    const unsigned char *c = (const unsigned char*)codiceParziale;
+    int resto = VALORE_CIN[0][c[0]] + VALORE_CIN[1][c[1]] + VALORE_CIN[0][c[2]] + VALORE_CIN[1][c[3]]
+              + VALORE_CIN[0][c[4]] + VALORE_CIN[1][c[5]] + VALORE_CIN[0][c[6]] + VALORE_CIN[1][c[7]]
+              + VALORE_CIN[0][c[8]] + VALORE_CIN[1][c[9]] + VALORE_CIN[0][c[10]] + VALORE_CIN[1][c[11]]
+              + VALORE_CIN[0][c[12]] + VALORE_CIN[1][c[13]] + VALORE_CIN[0][c[14]];
+    return CARATTERI_RESTO[resto % 26];
+}
+
+// Restituisce il codice fiscale della persona oppure NULL se l'allocazione fallisce
+char* CalcolaCodiceFiscale(char codNome[], char codCognome[], char codDataNascita[], char codCatastale[]){
+    char *codiceFiscale = calloc(LEN_CF + 1, sizeof(char));
+    if(codiceFiscale == NULL){
+        return NULL;
+    }
+
+    // Costruisco il codice fiscale accostando le varie parti.
+    // Non sono necessari altri controlli in quanto sono svolti dalle singole funzioni di codifica delle singole parti
+    memcpy(codiceFiscale + POS_COD_COGNOME, codCognome, LEN_COD_COGNOME);
+    memcpy(codiceFiscale + POS_COD_NOME, codNome, LEN_COD_NOME);
+    memcpy(codiceFiscale + POS_COD_DN, codDataNascita, LEN_COD_DN);
+    memcpy(codiceFiscale + POS_COD_CATASTALE, codCatastale, LEN_COD_CATASTALE);
+    MISURA_FASE(FASE_CIN, codiceFiscale[POS_CIN] = CalcolaCarattereControllo(codiceFiscale));
+    return codiceFiscale;
+}
+
+// Scrive nel buffer passato come parametro il codice catastale del luogo di nascita (senza terminatore) in vigore alla
+// data di nascita. Restituisce 0 in caso di successo oppure il codice di errore
+int CercaCodiceCatastale(const char luogoNascita[], data dataNascita, char codCatastale[LEN_COD_CATASTALE]){
+    // Il catalogo storico, se disponibile, contiene i comuni soppressi o rinominati e i codici sostituiti nel tempo: se
+    // alla data di nascita era in vigore un periodo del luogo indicato viene usato il suo codice, anche se oggi il nome
+    // esiste ancora con un codice diverso
+    const catalogoStorico *storico = CatalogoStoricoCondiviso();
+    const comune *luogo;
+    if(storico != NULL){
+        int errore = CercaComuneStorico(storico, luogoNascita, strlen(luogoNascita),
+                                        DataCompatta(dataNascita.giorno, dataNascita.mese, dataNascita.anno), &luogo);
+        if(errore == 0){
+            memcpy(codCatastale, luogo->codice, LEN_COD_CATASTALE);
+        }
+        if(errore != ERR_LUOGO_NASCITA){
+            return errore;
+        }
+    }
+
+    // Il catalogo dei comuni viene caricato dal file codiciCatastali.csv una sola volta per tutto il processo. La
+    // lettura protetta consente di ricaricarlo in qualsiasi momento senza bloccare la ricerca
+    letturaCatalogo lettura = IniziaLetturaCatalogo();
+    if(lettura.cat == NULL){
+        TerminaLetturaCatalogo(lettura);
+        return ERR_CATALOGO;
+    }
+    // I comuni omonimi vengono distinti dalla sigla della provincia, ad esempio "Castro (LE)"
+    int errore = CercaComuneUnivoco(lettura.cat, luogoNascita, strlen(luogoNascita), &luogo);
+    if(errore == 0){
+        memcpy(codCatastale, luogo->codice, LEN_COD_CATASTALE);
+    }
+    TerminaLetturaCatalogo(lettura);
+    return errore;
+}
+
+// Converte una sequenza di al più maxCifre cifre decimali nel relativo valore. Restituisce -1 se la sequenza non è
+// valida
+static int LeggiNumero(const char testo[], size_t len, size_t maxCifre){
+    int valore = 0;
+    if(len == 0 || len > maxCifre){
+        return -1;
+    }
+    for(size_t i=0; i<len; i++){
+        if(testo[i] < '0' || testo[i] > '9'){
+            return -1;
+        }
+        valore = valore * 10 + (testo[i] - '0');
+    }
+    return valore;
+}
+
+// Interpreta una data nel formato "gg/mm/aaaa": giorno e mese hanno al più due cifre e l'anno al più quattro.
+// Restituisce false se il formato non è valido
+static bool LeggiData(const char testo[], data *dataNascita){
+    const char *primo = strchr(testo, '/');
+    const char *secondo = primo != NULL ? strchr(primo + 1, '/') : NULL;
+    if(secondo == NULL){
+        return false;
+    }
+    dataNascita->giorno = LeggiNumero(testo, (size_t)(primo - testo), CIFRE_GIORNO);
+    dataNascita->mese = LeggiNumero(primo + 1, (size_t)(secondo - primo - 1), CIFRE_MESE);
+    dataNascita->anno = LeggiNumero(secondo + 1, strlen(secondo + 1), CIFRE_ANNO);
+    return dataNascita->giorno >= 0 && dataNascita->mese >= 0 && dataNascita->anno >= 0;
+}
+
+int LeggiPersona(char riga[], persona *persona){
+    char *campi[NUM_CAMPI_PERSONA];
+    int numCampi = 0;
+
+    // Suddivido la riga nei singoli campi terminandoli direttamente all'interno del buffer di lettura
+    campi[numCampi++] = riga;
+    for(char *c = riga; *c != '\0'; c++){
+        if(*c == DIV_CHAR || *c == SEP_TAB){
+            if(numCampi == NUM_CAMPI_PERSONA){
+                return ERR_DATI;
+            }
+            *c = '\0';
+            campi[numCampi++] = c + 1;
+        }
+    }
+    if(numCampi != NUM_CAMPI_PERSONA){
+        return ERR_DATI;
+    }
+
+    persona->nome = campi[0];
+    persona->cognome = campi[1];
+    persona->sesso = (char)toupper((unsigned char)campi[2][0]);
+    persona->luogoNascita = campi[4];
+    if(campi[2][1] != '\0' || !LeggiData(campi[3], &persona->dataNascita)){
+        return ERR_DATI;
+    }
+    return 0;
+}
+
+int CodificaPersona(const persona *persona, char codiceFiscale[LEN_CF + 1]){
+    if(!ValidaNome(persona->nome) || !ValidaCognome(persona->cognome)
+       || (persona->sesso != 'M' && persona->sesso != 'F') || !ValidaData(persona->dataNascita)){
+        return ERR_DATI;
+    }
+    // Il codice catastale viene scritto direttamente nella sua posizione all'interno del codice fiscale
+    int errore;
+    MISURA_FASE(FASE_CODICE_CATASTALE, errore = CercaCodiceCatastale(persona->luogoNascita, persona->dataNascita,
+                                                                      codiceFiscale + POS_COD_CATASTALE));
+    if(errore != 0){
+        return errore;
+    }
+
+    MISURA_FASE(FASE_COGNOME, ScriviCodificaCognome(persona->cognome, codiceFiscale + POS_COD_COGNOME));
+    MISURA_FASE(FASE_NOME, ScriviCodificaNome(persona->nome, codiceFiscale + POS_COD_NOME));
+    MISURA_FASE(FASE_DATA, ScriviCodificaDataNascita(persona->dataNascita, persona->sesso, codiceFiscale + POS_COD_DN));
+    MISURA_FASE(FASE_CIN, codiceFiscale[POS_CIN] = CalcolaCarattereControllo(codiceFiscale));
+    codiceFiscale[LEN_CF] = '\0';
+    return 0;
+}
+
+// Converte due cifre decimali (eventualmente sostituite dalle lettere di omocodia) nel relativo valore.
+// Restituisce -1 se i caratteri non sono cifre
+static int LeggiDueCifre(const char cifre[2]){
+    int decine = ValoreCifra(cifre[0]), unita = ValoreCifra(cifre[1]);
+    if(decine < 0 || unita < 0){
+        return -1;
+    }
+    return decine * 10 + unita;
+}
+
+// Copia il codice catastale contenuto nel codice fiscale riportando alle cifre originali le lettere di omocodia
+static void CopiaCodiceCatastale(const char codiceFiscale[LEN_CF], char codCatastale[LEN_COD_CATASTALE]){
+    codCatastale[0] = codiceFiscale[POS_COD_CATASTALE];
+    for(int i=1; i<LEN_COD_CATASTALE; i++){
+        int cifra = ValoreCifra(codiceFiscale[POS_COD_CATASTALE + i]);
+        codCatastale[i] = cifra < 0 ? codiceFiscale[POS_COD_CATASTALE + i] : (char)('0' + cifra);
+    }
+}
+
+int DecodificaCodiceFiscale(const char codiceFiscale[LEN_CF], int annoRiferimento, datiCodiceFiscale *dati){
+    const char *codDN = codiceFiscale + POS_COD_DN;
+    int anno = LeggiDueCifre(codDN);
+    int mese = MESE_DA_LETTERA[(unsigned char)codDN[2]];
+    int giorno = LeggiDueCifre(codDN + 3);
+    if(anno < 0 || mese == 0 || giorno < 0){
+        return ERR_DATI;
+    }
+
+    // Il giorno dei soggetti femminili è aumentato di 40
+    dati->sesso = 'M';
+    if(giorno > 40){
+        dati->sesso = 'F';
+        giorno -= 40;
+    }
+    anno += annoRiferimento - annoRiferimento % 100;
+    if(anno > annoRiferimento){
+        anno -= 100;
+    }
+    dati->dataNascita.giorno = giorno;
+    dati->dataNascita.mese = mese;
+    dati->dataNascita.anno = anno;
+    if(!ValidaData(dati->dataNascita)){
+        return ERR_DATI;
+    }
+
+    char codCatastale[LEN_COD_CATASTALE];
+    CopiaCodiceCatastale(codiceFiscale, codCatastale);
+    const catalogoStorico *storico = CatalogoStoricoCondiviso();
+    // Il comune viene copiato prima della fine della lettura, dopo la quale una ricarica può liberare il catalogo
+    letturaCatalogo lettura = IniziaLetturaCatalogo();
+    if(lettura.cat == NULL){
+        TerminaLetturaCatalogo(lettura);
+        return ERR_CATALOGO;
+    }
+    const comune *luogo = CercaComunePerCodice(lettura.cat, codCatastale);
+    if(luogo == NULL && storico != NULL){
+        // Codice di un comune soppresso o rinominato
+        luogo = CercaComuneStoricoPerCodice(storico, codCatastale);
+    }
+    if(luogo != NULL){
+        dati->lenLuogoNascita = luogo->lenNome < LEN_MAX_NOME_LUOGO ? luogo->lenNome : LEN_MAX_NOME_LUOGO;
+        memcpy(dati->luogoNascita, luogo->nome, dati->lenLuogoNascita);
+        memcpy(dati->provincia, luogo->provincia, LEN_SIGLA_PROVINCIA);
+    }
+    TerminaLetturaCatalogo(lettura);
+    return luogo != NULL ? 0 : ERR_LUOGO_NASCITA;
+}
+
+// Controlla che ogni posizione contenga solo lettere oppure solo cifre (o le lettere che le sostituiscono in caso di
+// omocodia). Con SSE2 l'intero codice viene controllato con un unico registro da 16 byte
+static bool CaratteriAmmessi(const char codiceFiscale[LEN_CF]){
+#ifdef USA_SSE2
+    __m128i c = _mm_loadu_si128((const __m128i*)codiceFiscale);
+    // I confronti sono con segno: i byte non ASCII risultano negativi e quindi esclusi da tutte le classi
+    __m128i cifre = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i lettere = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    __m128i omocodia = _mm_andnot_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('O')),
+                                        _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('L' - 1)),
+                                                      _mm_cmplt_epi8(c, _mm_set1_epi8('V' + 1))));
+    __m128i posLettere = _mm_loadu_si128((const __m128i*)POSIZIONI_LETTERE);
+    __m128i ammessi = _mm_or_si128(_mm_and_si128(posLettere, lettere),
+                                   _mm_andnot_si128(posLettere, _mm_or_si128(cifre, omocodia)));
+    return _mm_movemask_epi8(ammessi) == 0xFFFF;
+#else
+    const unsigned char *c = (const unsigned char*)codiceFiscale;
+    for(int i=0; i<LEN_CF; i++){
+        if((CLASSE_CARATTERE[c[i]] & CLASSE_POSIZIONE[i]) == 0){
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+#ifdef USA_SSSE3
+// Le funzioni SSSE3 vengono compilate per SSSE3 anche quando l'eseguibile non lo richiede
+#ifdef SCELTA_SSSE3
+#define FUNZIONE_SSSE3 __attribute__((target("ssse3")))
+#else
+#define FUNZIONE_SSSE3
+#endif
+
+// Inverso di 26 in virgola fissa a 16 bit, arrotondato per eccesso: per le somme del carattere di controllo (al massimo
+// 15 * 25) la parte alta del prodotto coincide con il quoziente della divisione per 26
+#define INVERSO_26 2521
+
+// Restituisce i valori dei 15 caratteri che concorrono al calcolo del carattere di controllo (e 0 nell'ultima
+// posizione), ricavati con due ricerche in tabella vettoriali
+static inline FUNZIONE_SSSE3 __m128i ValoriCIN(__m128i c){
+    // Indice del carattere: da 0 a 9 per le cifre e da 0 a 25 per le lettere ('A' - '0' = 17)
+    __m128i lettere = _mm_cmpgt_epi8(c, _mm_set1_epi8('9'));
+    __m128i indice = _mm_sub_epi8(_mm_sub_epi8(c, _mm_set1_epi8('0')), _mm_and_si128(lettere, _mm_set1_epi8('A' - '0')));
+    __m128i alto = _mm_cmpgt_epi8(indice, _mm_set1_epi8(15));
+    __m128i dispari = _mm_or_si128(
+            _mm_andnot_si128(alto, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)DISPARI_BASSI), indice)),
+            _mm_and_si128(alto, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)DISPARI_ALTI),
+                                                 _mm_sub_epi8(indice, _mm_set1_epi8(16)))));
+    // Nelle posizioni pari il valore coincide con l'indice
+    __m128i posDispari = _mm_loadu_si128((const __m128i*)POSIZIONI_DISPARI);
+    __m128i valori = _mm_or_si128(_mm_and_si128(posDispari, dispari), _mm_andnot_si128(posDispari, indice));
+    return _mm_and_si128(valori, _mm_loadu_si128((const __m128i*)POSIZIONI_CIN));
+}
+
+// Calcola il carattere di controllo con SSSE3: i valori dei 15 caratteri vengono sommati con un'unica istruzione
+static FUNZIONE_SSSE3 char CarattereControlloSSSE3(const char codiceFiscale[LEN_CF]){
+    __m128i somma = _mm_sad_epu8(ValoriCIN(_mm_loadu_si128((const __m128i*)codiceFiscale)), _mm_setzero_si128());
+    int resto = _mm_cvtsi128_si32(somma) + _mm_extract_epi16(somma, 4);
+    return CARATTERI_RESTO[resto % 26];
+}
+
+// Calcola con SSSE3 i caratteri di controllo di più codici, 8 per iterazione: le somme degli 8 codici vengono raccolte
+// in un unico registro, in cui restano da calcolare il resto della divisione per 26 e la lettera corrispondente
+static FUNZIONE_SSSE3 void CarattereControlloBloccoSSSE3(const char (*codici)[LEN_CF], size_t numCodici,
+                                                          char caratteri[]){
+    size_t i = 0;
+    for(; i + 8 <= numCodici; i += 8){
+        __m128i coppie[4];
+        for(int j=0; j<4; j++){
+            // Ogni somma parziale occupa i 16 bit bassi di una metà del registro: le due metà di ogni codice vengono
+            // sommate lasciando la somma di due codici nei 32 bit bassi delle due metà
+            __m128i zero = _mm_setzero_si128();
+            __m128i a = _mm_sad_epu8(ValoriCIN(_mm_loadu_si128((const __m128i*)codici[i + 2 * j])), zero);
+            __m128i b = _mm_sad_epu8(ValoriCIN(_mm_loadu_si128((const __m128i*)codici[i + 2 * j + 1])), zero);
+            coppie[j] = _mm_add_epi64(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+        }
+        // Due riduzioni a 16 bit portano le 8 somme, nell'ordine dei codici, negli 8 elementi di un registro
+        __m128i somme = _mm_packs_epi32(_mm_packs_epi32(coppie[0], coppie[1]), _mm_packs_epi32(coppie[2], coppie[3]));
+        __m128i quozienti = _mm_mulhi_epu16(somme, _mm_set1_epi16(INVERSO_26));
+        __m128i resti = _mm_sub_epi16(somme, _mm_mullo_epi16(quozienti, _mm_set1_epi16(26)));
+        __m128i lettere = _mm_add_epi16(resti, _mm_set1_epi16('A'));
+        _mm_storel_epi64((__m128i*)(caratteri + i), _mm_packus_epi16(lettere, lettere));
+    }
+    for(; i < numCodici; i++){
+        caratteri[i] = CarattereControlloSSSE3(codici[i]);
+    }
+}
+#endif
+
+// Calcola il carattere di controllo di un codice fiscale completo (di cui deve essere possibile leggere tutti i 16
+// caratteri) già verificato da CaratteriAmmessi: con SSSE3 se disponibile, altrimenti con CalcolaCarattereControllo
+static char CarattereControlloVerificato(const char codiceFiscale[LEN_CF]){
+#if defined(SCELTA_SSSE3)
+    // Le caratteristiche del processore vengono rilevate una sola volta all'avvio del programma
+    if(__builtin_cpu_supports("ssse3")){
+        return CarattereControlloSSSE3(codiceFiscale);
+    }
+    return CalcolaCarattereControllo(codiceFiscale);
+#elif defined(USA_SSSE3)
+    return CarattereControlloSSSE3(codiceFiscale);
+#else
+    return CalcolaCarattereControllo(codiceFiscale);
+#endif
+}
+
+void CalcolaCarattereControlloBlocco(const char (*codici)[LEN_CF], size_t numCodici, char caratteri[]){
+#if defined(SCELTA_SSSE3)
+    if(__builtin_cpu_supports("ssse3")){
+        CarattereControlloBloccoSSSE3(codici, numCodici, caratteri);
+        return;
+    }
+#elif defined(USA_SSSE3)
+    CarattereControlloBloccoSSSE3(codici, numCodici, caratteri);
+    return;
+#endif
+    for(size_t i=0; i<numCodici; i++){
+        caratteri[i] = CalcolaCarattereControllo(codici[i]);
+    }
+}
+
+void MaiuscoloCodiceFiscale(char codiceFiscale[], size_t len){
+    for(size_t i=0; i<len; i++){
+        codiceFiscale[i] = (char)toupper((unsigned char)codiceFiscale[i]);
+    }
+}
+
+int ValidaCodiceFiscaleSenzaCIN(const char codiceFiscale[], size_t len, int annoRiferimento){
+    const unsigned char *c = (const unsigned char*)codiceFiscale;
+    if(len != LEN_CF){
+        return ERR_CF_LUNGHEZZA;
+    }
+    if(!CaratteriAmmessi(codiceFiscale)){
+        return ERR_CF_CARATTERI;
+    }
+
+    int mese = MESE_DA_LETTERA[c[POS_COD_DN + 2]];
+    if(mese == 0){
+        return ERR_CF_MESE;
+    }
+    // I controlli sui caratteri garantiscono che anno e giorno siano composti da cifre
+    int giorno = LeggiDueCifre(codiceFiscale + POS_COD_DN + 3);
+    if(giorno > 40){
+        giorno -= 40;
+    }
+    int anno = LeggiDueCifre(codiceFiscale + POS_COD_DN);
+    anno += annoRiferimento - annoRiferimento % 100;
+    if(anno > annoRiferimento){
+        anno -= 100;
+    }
+    // I giorni validi sono da 1 a 31 per i soggetti maschili e da 41 a 71 per quelli femminili
+    if(giorno < 1 || giorno > GiorniNelMese(mese, anno)){
+        return ERR_CF_GIORNO;
+    }
+
+    char codCatastale[LEN_COD_CATASTALE];
+    CopiaCodiceCatastale(codiceFiscale, codCatastale);
+    const catalogoStorico *storico = CatalogoStoricoCondiviso();
+    letturaCatalogo lettura = IniziaLetturaCatalogo();
+    bool presente = lettura.cat != NULL && CercaComunePerCodice(lettura.cat, codCatastale) != NULL;
+    TerminaLetturaCatalogo(lettura);
+    if(!presente && (storico == NULL || CercaComuneStoricoPerCodice(storico, codCatastale) == NULL)){
+        return ERR_CF_COMUNE;
+    }
+    return CF_VALIDO;
+}
+
+int ValidaCodiceFiscale(const char codiceFiscale[], size_t len, int annoRiferimento){
+    int esito = ValidaCodiceFiscaleSenzaCIN(codiceFiscale, len, annoRiferimento);
+    if(esito == CF_VALIDO && CarattereControlloVerificato(codiceFiscale) != codiceFiscale[POS_CIN]){
+        return ERR_CF_CIN;
+    }
+    return esito;
+}
+
+int NormalizzaCodiceFiscale(const char codiceFiscale[LEN_CF], char canonico[LEN_CF + 1], int *maschera){
+    int sostituzioni = 0;
+    memcpy(canonico, codiceFiscale, LEN_CF);
+    for(int i=0; i<NUM_POSIZIONI_OMOCODIA; i++){
+        char c = canonico[POSIZIONI_OMOCODIA[i]];
+        int cifra = ValoreCifra(c);
+        if(cifra < 0){
+            return ERR_DATI;
+        }
+        if(c > '9'){
+            canonico[POSIZIONI_OMOCODIA[i]] = (char)('0' + cifra);
+            sostituzioni |= 1 << i;
+        }
+    }
+    canonico[POS_CIN] = CalcolaCarattereControllo(canonico);
+    canonico[LEN_CF] = '\0';
+    if(maschera != NULL){
+        *maschera = sostituzioni;
+    }
+    return 0;
+}
+
+int GeneraVariantiOmocodia(const char codiceFiscale[LEN_CF], char varianti[NUM_VARIANTI_OMOCODIA][LEN_CF + 1]){
+    char codice[LEN_CF + 1];
+    int errore = NormalizzaCodiceFiscale(codiceFiscale, codice, NULL);
+    if(errore != 0){
+        return errore;
+    }
+
+    // Le varianti vengono visitate secondo il codice di Gray: ogni variante differisce dalla precedente per una sola
+    // posizione, quindi la somma per il carattere di controllo viene corretta con la sola differenza dei due valori
+    int somma = 0;
+    for(int i=0; i<LEN_CF - 1; i++){
+        somma += VALORE_CIN[i & 1][(unsigned char)codice[i]];
+    }
+    memcpy(varianti[0], codice, LEN_CF + 1);
+    for(int k=1; k<NUM_VARIANTI_OMOCODIA; k++){
+        // Il bit che cambia tra due codici di Gray consecutivi è quello meno significativo impostato in k
+        int bit = 0;
+        while(!(k & (1 << bit))){
+            bit++;
+        }
+        int pos = POSIZIONI_OMOCODIA[bit];
+        char prima = codice[pos];
+        char dopo = prima > '9' ? (char)('0' + ValoreCifra(prima)) : CIFRE_OMOCODIA[prima - '0'];
+        somma += VALORE_CIN[pos & 1][(unsigned char)dopo] - VALORE_CIN[pos & 1][(unsigned char)prima];
+        codice[pos] = dopo;
+        codice[POS_CIN] = CARATTERI_RESTO[somma % 26];
+        memcpy(varianti[k ^ (k >> 1)], codice, LEN_CF + 1);
+    }
+    return 0;
+}
+
+// Restituisce la codifica del nome della persona oppure NULL se l'allocazione fallisce
+char* CodificaNome(char nome[]) {
+    // La funzione restituisce un puntatore ad una stringa allocata dinamicamente
+    char *codNome = calloc(LEN_COD_NOME + 1, sizeof(char));
+    // Controllo di avvenuta allocazione
+    if(codNome == NULL){
+        return NULL;
+    }
+    MISURA_FASE(FASE_NOME, ScriviCodificaNome(nome, codNome));
+    return codNome;
+}
+
+// Restituisce la codifica del cognome della persona oppure NULL se l'allocazione fallisce
+char* CodificaCognome(char cognome[]) {
+    // La funzione restituisce un puntatore ad una stringa allocata dinamicamente
+    char *codCognome = calloc(LEN_COD_COGNOME + 1, sizeof(char));
+    // Controllo di avvenuta allocazione
+    if(codCognome == NULL){
+        return NULL;
+    }
+    MISURA_FASE(FASE_COGNOME, ScriviCodificaCognome(cognome, codCognome));
+    return codCognome;
+}
+
+// Restituisce la codifica della data di nascita della persona oppure NULL se l'allocazione fallisce
+char* CodificaDataNascita(data data, char sesso){
+    char *codificaData = calloc(LEN_COD_DN + 1, sizeof(char));
+    if(codificaData == NULL){
+        return NULL;
+    }
+    MISURA_FASE(FASE_DATA, ScriviCodificaDataNascita(data, sesso, codificaData));
+    return codificaData;
+}
@@ -0,0 +1,169 @@
+#ifndef CODIFICA_CF_H
+#define CODIFICA_CF_H
+
+#include <stdbool.h>
+
+#include "catalogoComuni.h"
+
+/* MODULO: Funzioni di validazione dei dati e di codifica delle singole parti del codice fiscale
+ * La funzione CodificaPersona costruisce l'intero codice fiscale nel buffer fornito dal chiamante senza alcuna
+ * allocazione dinamica; le funzioni Codifica* restituiscono invece le singole parti in stringhe allocate dinamicamente.
+ * La funzione DecodificaCodiceFiscale esegue il percorso inverso a partire da un codice già esistente.
+ * Le funzioni del modulo non eseguono alcuna operazione di input/output e non terminano mai il processo: ogni errore
+ * viene restituito al chiamante, in modo che la libreria codicefiscale possa essere inclusa in altri programmi.
+ */
+
+// Costanti generiche
+#define ANNO_MIN 1900
+#define NUM_MESI 12
+
+// Lunghezze delle stringhe che conterrano i dati della persona
+#define LEN_NOME 20
+#define LEN_COGNOME 20
+#define LEN_LUOGO_NASCITA 40
+// Lunghezza massima del nome del luogo di nascita ricavato da un codice fiscale (i nomi più lunghi vengono troncati)
+#define LEN_MAX_NOME_LUOGO 128
+
+// Lunghezze minime per la validazione dei parametri inseriti dall'utente
+#define LEN_MIN_NOME 3
+#define LEN_MIN_COGNOME 2
+#define LEN_MIN_LUOGO_NASCITA 2
+
+// Lunghezze delle singole codifiche
+#define LEN_COD_NOME 3
+#define LEN_COD_COGNOME 3
+#define LEN_COD_DN 5
+#define LEN_CF 16
+
+// Posizioni delle singole codifiche all'interno del codice fiscale
+#define POS_COD_COGNOME 0
+#define POS_COD_NOME 3
+#define POS_COD_DN 6
+#define POS_COD_CATASTALE 11
+#define POS_CIN 15
+
+// Omocodia: le 7 cifre del codice fiscale possono essere sostituite dalle lettere di CIFRE_OMOCODIA, a partire da destra.
+// Le varianti possibili di un codice sono 2^7: la variante con maschera m sostituisce le posizioni di POSIZIONI_OMOCODIA
+// corrispondenti ai bit impostati di m (bit 0 = cifra più a destra)
+#define NUM_POSIZIONI_OMOCODIA 7
+#define NUM_VARIANTI_OMOCODIA (1 << NUM_POSIZIONI_OMOCODIA)
+
+// Lettere corrispondenti ai mesi per la codifica della data di nascita
+extern const char MESI[NUM_MESI + 1];
+
+// Alfabeti per la determinazione del CIN
+extern const char CARATTERI[36];
+extern const int VALORE_CARATTERI_DISPARI[36];
+extern const int VALORE_CARATTERI_PARI[36];
+extern const char CARATTERI_RESTO[26];
+
+// Lettere che sostituiscono le cifre da 0 a 9 e posizioni sostituibili in caso di omocodia (da destra verso sinistra)
+extern const char CIFRE_OMOCODIA[10];
+extern const unsigned char POSIZIONI_OMOCODIA[NUM_POSIZIONI_OMOCODIA];
+
+typedef struct DATA {
+    int giorno;
+    int mese;
+    int anno;
+}data;
+
+typedef struct PERSONA {
+    const char *nome;
+    const char *cognome;
+    char sesso;
+    data dataNascita;
+    const char *luogoNascita;
+}persona;
+
+// Esiti della validazione di un codice fiscale
+#define CF_VALIDO 0
+#define ERR_CF_LUNGHEZZA 1
+#define ERR_CF_CARATTERI 2
+#define ERR_CF_MESE 3
+#define ERR_CF_GIORNO 4
+#define ERR_CF_COMUNE 5
+#define ERR_CF_CIN 6
+#define NUM_ESITI_CF 7
+
+// Descrizione di ciascun esito della validazione
+extern const char *const DESCRIZIONE_ESITO_CF[NUM_ESITI_CF];
+
+// Dati della persona ricavati da un codice fiscale
+typedef struct DATI_CODICE_FISCALE {
+    char sesso;
+    data dataNascita;
+    char luogoNascita[LEN_MAX_NOME_LUOGO];     // Nome del comune o dello stato, senza terminatore
+    size_t lenLuogoNascita;
+    char provincia[LEN_SIGLA_PROVINCIA];       // Sigla della provincia (due spazi se assente nel catalogo)
+}datiCodiceFiscale;
+
+// Validazione dei dati della persona
+bool IsVocale(char c);
+int ContaConsonanti(const char parola[]);
+bool ValidaNome(const char nome[]);
+bool ValidaCognome(const char cognome[]);
+bool ValidaLuogoNascita(const char luogoNascita[]);
+int GiorniNelMese(int mese, int anno);
+bool ValidaData(data data);
+
+// Interpreta una riga nel formato della codifica ("nome;cognome;sesso;gg/mm/aaaa;luogo di nascita", con DIV_CHAR
+// oppure il carattere di tabulazione come separatore), terminando i campi all'interno della riga stessa: i campi di
+// persona puntano quindi alla riga. Restituisce 0 in caso di successo oppure ERR_DATI se la riga non è valida
+int LeggiPersona(char riga[], persona *persona);
+
+// Calcola il codice fiscale della persona scrivendolo (con terminatore) nel buffer passato come parametro.
+// Restituisce 0 in caso di successo oppure il codice di errore
+int CodificaPersona(const persona *persona, char codiceFiscale[LEN_CF + 1]);
+
+// Scrive il codice catastale del luogo di nascita in vigore alla data di nascita (consultando anche il catalogo storico
+// se disponibile). Restituisce 0 in caso di successo oppure il codice di errore
+int CercaCodiceCatastale(const char luogoNascita[], data dataNascita, char codCatastale[LEN_COD_CATASTALE]);
+
+// Ricava sesso, data e luogo di nascita da un codice fiscale (non è richiesto il terminatore). Le due cifre dell'anno
+// vengono attribuite al secolo più recente che non superi l'anno di riferimento. Il nome del luogo di nascita viene
+// copiato in dati, che restano quindi validi anche dopo una ricarica del catalogo (vedi RicaricaCatalogo).
+// Restituisce 0 in caso di successo oppure il codice di errore
+int DecodificaCodiceFiscale(const char codiceFiscale[LEN_CF], int annoRiferimento, datiCodiceFiscale *dati);
+
+// Converte in maiuscolo un codice fiscale ricevuto in ingresso: la decodifica e la validazione (in modalità batch e nel
+// servizio) accettano così anche i codici scritti in minuscolo
+void MaiuscoloCodiceFiscale(char codiceFiscale[], size_t len);
+
+// Controlla un codice fiscale esistente: caratteri ammessi in ogni posizione (comprese le lettere di omocodia), mese,
+// giorno di nascita, presenza del codice catastale nel catalogo (attuale o storico) e carattere di controllo.
+// Restituisce CF_VALIDO oppure l'esito ERR_CF_* relativo al primo controllo non superato
+int ValidaCodiceFiscale(const char codiceFiscale[], size_t len, int annoRiferimento);
+
+// Esegue tutti i controlli di ValidaCodiceFiscale tranne quello del carattere di controllo, in modo che i caratteri di
+// controllo di più codici possano essere verificati insieme con CalcolaCarattereControlloBlocco
+int ValidaCodiceFiscaleSenzaCIN(const char codiceFiscale[], size_t len, int annoRiferimento);
+
+// Genera tutte le varianti per omocodia del codice fiscale passato come parametro, che può essere a sua volta una
+// qualsiasi variante: varianti[m] contiene il codice con le sostituzioni indicate dalla maschera m (varianti[0] è il
+// codice originale). Il carattere di controllo viene aggiornato ad ogni sostituzione senza ricalcolarlo per intero.
+// Restituisce 0 in caso di successo oppure il codice di errore se le posizioni sostituibili non contengono cifre
+int GeneraVariantiOmocodia(const char codiceFiscale[LEN_CF], char varianti[NUM_VARIANTI_OMOCODIA][LEN_CF + 1]);
+
+// Riporta una qualsiasi variante per omocodia al codice fiscale originale (con sole cifre e carattere di controllo
+// ricalcolato). Se maschera non è NULL vi viene scritta la maschera delle sostituzioni presenti nella variante.
+// Restituisce 0 in caso di successo oppure il codice di errore se le posizioni sostituibili non contengono cifre
+int NormalizzaCodiceFiscale(const char codiceFiscale[LEN_CF], char canonico[LEN_CF + 1], int *maschera);
+
+// Codifica delle singole parti del codice fiscale: le stringhe restituite sono allocate dinamicamente (NULL se
+// l'allocazione fallisce) e devono essere liberate dal chiamante
+char* CodificaNome(char nome[]);
+char* CodificaCognome(char cognome[]);
+char* CodificaDataNascita(data data, char sesso);
+char CalcolaCIN(char codiceFiscaleParziale[]);
+
+// Restituisce il carattere di controllo relativo ai primi 15 caratteri di un codice fiscale (non è richiesto il terminatore)
+char CalcolaCarattereControllo(const char codiceParziale[LEN_CF - 1]);
+
+// Scrive in caratteri[i] il carattere di controllo relativo ai primi 15 caratteri di codici[i], elaborando più codici
+// per iterazione con SSSE3 se il processore lo supporta. Devono essere leggibili tutti i 16 caratteri di ogni codice,
+// composti solo da cifre e lettere maiuscole (come quelli che superano ValidaCodiceFiscaleSenzaCIN): per gli altri
+// caratteri il risultato non è specificato
+void CalcolaCarattereControlloBlocco(const char (*codici)[LEN_CF], size_t numCodici, char caratteri[]);
+char* CalcolaCodiceFiscale(char codNome[], char codCognome[], char codDataNascita[], char codCatastale[]);
+
+#endif
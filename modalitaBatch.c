@@ -0,0 +1,610 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "catalogoComuni.h"
+#include "catalogoStorico.h"
+#include "codiciErrore.h"
+#include "codificaCF.h"
+#include "modalitaBatch.h"
+#include "strumentazione.h"
+
+// Numero massimo di blocchi letti e non ancora scritti nella modalità parallela
+#define MAX_BLOCCHI_IN_VOLO 64
+
+// Lunghezza massima del risultato prodotto per una singola riga (escluso il carattere di fine riga)
+#define LEN_MAX_RISULTATO 128
+
+// Numero di righe della validazione i cui caratteri di controllo vengono verificati insieme
+#define RIGHE_GRUPPO_VALIDAZIONE 64
+
+// Elabora un record scrivendo il risultato (senza fine riga e senza terminatore) nel buffer passato come parametro.
+// Restituisce 0 in caso di successo oppure il codice di errore
+typedef int (*elaboraRecord)(char riga[], char risultato[LEN_MAX_RISULTATO], size_t *lenRisultato);
+
+// Anno a cui si riferisce la decodifica delle due cifre dell'anno di nascita (impostato prima dell'elaborazione)
+static int annoRiferimento;
+
+// Buffer di scrittura: i risultati vengono accumulati e scritti su file in un'unica operazione per blocco.
+// Se il file è NULL il buffer contiene tutti i risultati e viene scritto successivamente
+typedef struct USCITA {
+    char *dati;
+    size_t len;
+    size_t capacita;
+    FILE *file;
+    long numRecord;
+    long numErrori;
+    bool erroreAllocazione;
+}uscita;
+
+// Blocco di righe complete elaborato da un singolo thread nella modalità parallela
+typedef struct BLOCCO {
+    char *testo;
+    size_t lenTesto;
+    uscita out;
+    uscita scarti;
+    unsigned long sequenza;
+    struct BLOCCO *successivo;
+}blocco;
+
+// Stato condiviso tra il thread di lettura, i thread di calcolo e il thread di scrittura
+typedef struct PIPELINE {
+    pthread_mutex_t mutex;
+    pthread_cond_t lavoroDisponibile;
+    pthread_cond_t bloccoCompletato;
+    pthread_cond_t spazioDisponibile;
+    blocco *primoDaElaborare;
+    blocco *ultimoDaElaborare;
+    blocco *completati[MAX_BLOCCHI_IN_VOLO]; // Blocchi elaborati in attesa di scrittura, indicizzati per sequenza
+    unsigned long numLetti;
+    unsigned long numScritti;
+    bool letturaConclusa;
+    FILE *file;
+    FILE *fileScarti;        // Destinazione dei record non validi (NULL se riportati insieme agli altri risultati)
+    elaboraRecord operazione;
+    long numRecord;
+    long numErrori;
+    bool erroreAllocazione;
+}pipeline;
+
+// Scrive su file il contenuto del buffer di uscita e lo svuota
+static void SvuotaUscita(uscita *out){
+    if(out->len > 0){
+        MISURA_FASE(FASE_SCRITTURA, fwrite(out->dati, 1, out->len, out->file));
+        out->len = 0;
+    }
+}
+
+// Accoda una stringa di lunghezza nota al buffer di uscita. Un buffer privo di file viene ingrandito se necessario
+static void ScriviUscita(uscita *out, const char testo[], size_t len){
+    if(out->len + len > out->capacita){
+        if(out->file != NULL){
+            SvuotaUscita(out);
+        }
+        else{
+            size_t capacita = 2 * out->capacita + len;
+            char *dati = realloc(out->dati, capacita);
+            if(dati == NULL){
+                out->erroreAllocazione = true;
+                return;
+            }
+            out->dati = dati;
+            out->capacita = capacita;
+        }
+    }
+    memcpy(out->dati + out->len, testo, len);
+    out->len += len;
+}
+
+// Calcola il codice fiscale relativo ad una singola riga. Restituisce 0 in caso di successo oppure il codice di errore
+static int CodificaRecord(char riga[], char risultato[LEN_MAX_RISULTATO], size_t *lenRisultato){
+    persona persona;
+    int errore;
+    MISURA_FASE(FASE_LETTURA, errore = LeggiPersona(riga, &persona));
+    if(errore != 0){
+        return errore;
+    }
+    *lenRisultato = LEN_CF;
+    return CodificaPersona(&persona, risultato);
+}
+
+// Ricava dal codice fiscale contenuto nella riga i dati della persona nel formato "codice;sesso;gg/mm/aaaa;luogo".
+// Restituisce 0 in caso di successo oppure il codice di errore
+static int DecodificaRecord(char riga[], char risultato[LEN_MAX_RISULTATO], size_t *lenRisultato){
+    datiCodiceFiscale dati;
+    if(strlen(riga) != LEN_CF){
+        return ERR_DATI;
+    }
+    MaiuscoloCodiceFiscale(riga, LEN_CF);
+    int errore = DecodificaCodiceFiscale(riga, annoRiferimento, &dati);
+    if(errore != 0){
+        return errore;
+    }
+
+    int len = snprintf(risultato, LEN_MAX_RISULTATO, "%s;%c;%02d/%02d/%04d;", riga, dati.sesso,
+                       dati.dataNascita.giorno, dati.dataNascita.mese, dati.dataNascita.anno);
+    size_t lenNome = dati.lenLuogoNascita;
+    if(len + lenNome > LEN_MAX_RISULTATO){
+        lenNome = LEN_MAX_RISULTATO - (size_t)len;
+    }
+    memcpy(risultato + len, dati.luogoNascita, lenNome);
+    *lenRisultato = (size_t)len + lenNome;
+    // La sigla della provincia, se presente nel catalogo, distingue i comuni omonimi
+    if(dati.provincia[0] != ' ' && *lenRisultato + LEN_SIGLA_PROVINCIA + 3 <= LEN_MAX_RISULTATO){
+        risultato[(*lenRisultato)++] = ' ';
+        risultato[(*lenRisultato)++] = '(';
+        memcpy(risultato + *lenRisultato, dati.provincia, LEN_SIGLA_PROVINCIA);
+        *lenRisultato += LEN_SIGLA_PROVINCIA;
+        risultato[(*lenRisultato)++] = ')';
+    }
+    return 0;
+}
+
+// Verifica il codice fiscale contenuto nella riga, che viene riportato in maiuscolo in uscita se valido, tranne il
+// carattere di controllo: quelli dei codici che superano gli altri controlli vengono verificati insieme da ValidaTesto.
+// Restituisce CF_VALIDO oppure l'esito ERR_CF_* della validazione
+static int ValidaRecord(char riga[], char risultato[LEN_MAX_RISULTATO], size_t *lenRisultato){
+    size_t len = strlen(riga);
+    MaiuscoloCodiceFiscale(riga, len);
+    int esito = ValidaCodiceFiscaleSenzaCIN(riga, len, annoRiferimento);
+    if(esito == CF_VALIDO){
+        memcpy(risultato, riga, LEN_CF);
+        *lenRisultato = LEN_CF;
+    }
+    return esito;
+}
+
+// Termina la riga (priva del carattere di fine riga) ignorando il carattere '\r' dei file con terminazioni di riga in
+// formato Windows. Restituisce la lunghezza della riga, 0 se la riga è vuota e va ignorata
+static size_t TerminaRiga(char riga[], size_t len){
+    if(len > 0 && riga[len - 1] == '\r'){
+        len--;
+    }
+    riga[len] = '\0';
+    return len;
+}
+
+// Accoda al buffer di uscita il risultato di una riga elaborata (lenRisultato caratteri di risultato, che deve avere
+// spazio per un carattere in più) oppure, in caso di errore, lo riporta negli scarti se non sono NULL nel formato
+// "riga;esito;descrizione" e altrimenti scrive al suo posto "ERRORE;<codice>" nel buffer di uscita
+static void ScriviEsito(const char riga[], int errore, char risultato[LEN_MAX_RISULTATO + 1], size_t lenRisultato,
+                        uscita *out, uscita *scarti){
+    out->numRecord++;
+    if(errore == 0){
+        risultato[lenRisultato] = '\n';
+        ScriviUscita(out, risultato, lenRisultato + 1);
+    }
+    else{
+        out->numErrori++;
+        if(scarti != NULL){
+            // La riga originale viene troncata se troppo lunga per il buffer del risultato
+            int lenMessaggio = snprintf(risultato, LEN_MAX_RISULTATO + 1, "%.*s;%d;%s\n", LEN_MAX_RISULTATO / 2, riga,
+                                        errore, DESCRIZIONE_ESITO_CF[errore]);
+            if(lenMessaggio > (int)LEN_MAX_RISULTATO){
+                lenMessaggio = LEN_MAX_RISULTATO;
+                risultato[lenMessaggio - 1] = '\n';
+            }
+            ScriviUscita(scarti, risultato, (size_t)lenMessaggio);
+        }
+        else{
+            int lenMessaggio = snprintf(risultato, LEN_MAX_RISULTATO + 1, "ERRORE;%d\n", errore);
+            ScriviUscita(out, risultato, (size_t)lenMessaggio);
+        }
+    }
+}
+
+// Elabora una riga completa (priva del carattere di fine riga) e accoda il risultato al buffer di uscita
+static void ElaboraRiga(char riga[], size_t len, elaboraRecord operazione, uscita *out, uscita *scarti){
+    char risultato[LEN_MAX_RISULTATO + 1];
+    size_t lenRisultato = 0;
+    if(TerminaRiga(riga, len) == 0){
+        return;
+    }
+    int errore = operazione(riga, risultato, &lenRisultato);
+    ScriviEsito(riga, errore, risultato, lenRisultato, out, scarti);
+}
+
+// Valida le righe del testo a gruppi: dopo i controlli di ValidaRecord su ogni riga del gruppo, i caratteri di
+// controllo dei codici che li hanno superati vengono calcolati insieme con CalcolaCarattereControlloBlocco
+static void ValidaTesto(char testo[], size_t len, uscita *out, uscita *scarti){
+    char *righe[RIGHE_GRUPPO_VALIDAZIONE];
+    int esiti[RIGHE_GRUPPO_VALIDAZIONE];
+    char codici[RIGHE_GRUPPO_VALIDAZIONE][LEN_CF];
+    char caratteri[RIGHE_GRUPPO_VALIDAZIONE];
+    char risultato[LEN_MAX_RISULTATO + 1];
+    size_t lenRisultato;
+
+    char *riga = testo, *fine = testo + len;
+    while(riga < fine){
+        int numRighe = 0;
+        size_t numCodici = 0;
+        while(riga < fine && numRighe < RIGHE_GRUPPO_VALIDAZIONE){
+            char *fineRiga = memchr(riga, '\n', (size_t)(fine - riga));
+            if(fineRiga == NULL){
+                fineRiga = fine;
+            }
+            if(TerminaRiga(riga, (size_t)(fineRiga - riga)) > 0){
+                righe[numRighe] = riga;
+                esiti[numRighe] = ValidaRecord(riga, risultato, &lenRisultato);
+                if(esiti[numRighe] == CF_VALIDO){
+                    memcpy(codici[numCodici++], riga, LEN_CF);
+                }
+                numRighe++;
+            }
+            riga = fineRiga < fine ? fineRiga + 1 : fine;
+        }
+
+        CalcolaCarattereControlloBlocco((const char (*)[LEN_CF])codici, numCodici, caratteri);
+        size_t k = 0;
+        for(int i=0; i<numRighe; i++){
+            if(esiti[i] == CF_VALIDO && caratteri[k++] != righe[i][POS_CIN]){
+                esiti[i] = ERR_CF_CIN;
+            }
+            memcpy(risultato, righe[i], LEN_CF);
+            ScriviEsito(righe[i], esiti[i], risultato, LEN_CF, out, scarti);
+        }
+    }
+}
+
+// Elabora tutte le righe contenute nel testo, compresa l'eventuale ultima riga priva del carattere di fine riga.
+// Il buffer deve avere spazio per un carattere oltre la lunghezza indicata
+static void ElaboraTesto(char testo[], size_t len, elaboraRecord operazione, uscita *out, uscita *scarti){
+    if(operazione == ValidaRecord){
+        ValidaTesto(testo, len, out, scarti);
+        return;
+    }
+    char *riga = testo, *fine = testo + len, *fineRiga;
+    while((fineRiga = memchr(riga, '\n', (size_t)(fine - riga))) != NULL){
+        ElaboraRiga(riga, (size_t)(fineRiga - riga), operazione, out, scarti);
+        riga = fineRiga + 1;
+    }
+    if(riga < fine){
+        ElaboraRiga(riga, (size_t)(fine - riga), operazione, out, scarti);
+    }
+}
+
+// Scrive sullo standard error il numero di record elaborati e di errori, tranne quando lo standard error riceve i
+// record scartati dalla validazione: il riepilogo verrebbe mescolato agli scarti
+static void StampaRiepilogo(const FILE *fileScarti, long numRecord, long numErrori){
+    if(fileScarti != stderr){
+        fprintf(stderr, "Record elaborati: %ld - Errori: %ld\n", numRecord, numErrori);
+    }
+}
+
+// Restituisce il file di input richiesto (lo standard input se il nome è NULL o "-")
+static FILE* ApriInput(const char nomeFileInput[]){
+    if(nomeFileInput == NULL || strcmp(nomeFileInput, "-") == 0){
+        return stdin;
+    }
+    return fopen(nomeFileInput, "rb");
+}
+
+// Elaborazione sequenziale: lettura, calcolo e scrittura si alternano in un unico thread
+static int ElaboraSequenziale(FILE *input, FILE *fileScarti, elaboraRecord operazione){
+    // Il buffer di lettura ha spazio per un blocco più l'eventuale riga incompleta del blocco precedente
+    // e per il terminatore dell'ultima riga
+    size_t capacita = 2 * LEN_BLOCCO_BATCH + 1;
+    char *buffer = malloc(capacita);
+    uscita out = {malloc(LEN_BLOCCO_BATCH), 0, LEN_BLOCCO_BATCH, stdout, 0, 0, false};
+    uscita scarti = {NULL, 0, 0, fileScarti, 0, 0, false};
+    if(fileScarti != NULL){
+        scarti.dati = malloc(LEN_BLOCCO_BATCH);
+        scarti.capacita = LEN_BLOCCO_BATCH;
+    }
+    if(buffer == NULL || out.dati == NULL || (fileScarti != NULL && scarti.dati == NULL)){
+        free(buffer);
+        free(out.dati);
+        free(scarti.dati);
+        return ERR_ALLOCAZIONE;
+    }
+
+    size_t len = 0, letti;
+    bool fineFile = false;
+    while(!fineFile){
+        letti = fread(buffer + len, 1, capacita - len - 1, input);
+        fineFile = letti == 0;
+        len += letti;
+
+        // Elaboro tutte le righe complete presenti nel buffer. L'ultima riga del file (oppure una riga più lunga
+        // del buffer) viene elaborata così com'è, mentre un'eventuale riga incompleta viene spostata all'inizio
+        size_t lenRighe = len;
+        if(!fineFile){
+            while(lenRighe > 0 && buffer[lenRighe - 1] != '\n'){
+                lenRighe--;
+            }
+            if(lenRighe == 0 && len == capacita - 1){
+                lenRighe = len;
+            }
+        }
+        ElaboraTesto(buffer, lenRighe, operazione, &out, fileScarti != NULL ? &scarti : NULL);
+        len -= lenRighe;
+        memmove(buffer, buffer + lenRighe, len);
+    }
+    SvuotaUscita(&out);
+    fflush(out.file);
+    if(fileScarti != NULL){
+        SvuotaUscita(&scarti);
+        fflush(fileScarti);
+    }
+
+    StampaRiepilogo(fileScarti, out.numRecord, out.numErrori);
+    free(buffer);
+    free(out.dati);
+    free(scarti.dati);
+    return 0;
+}
+
+// Libera la memoria occupata da un blocco
+static void LiberaBlocco(blocco *b){
+    free(b->testo);
+    free(b->out.dati);
+    free(b->scarti.dati);
+    free(b);
+}
+
+// Thread di calcolo: preleva i blocchi in ordine di lettura e li consegna elaborati al thread di scrittura
+static void* ThreadCalcolo(void *arg){
+    pipeline *p = arg;
+    while(true){
+        pthread_mutex_lock(&p->mutex);
+        while(p->primoDaElaborare == NULL && !p->letturaConclusa){
+            pthread_cond_wait(&p->lavoroDisponibile, &p->mutex);
+        }
+        blocco *b = p->primoDaElaborare;
+        if(b == NULL){
+            pthread_mutex_unlock(&p->mutex);
+            return NULL;
+        }
+        p->primoDaElaborare = b->successivo;
+        if(p->primoDaElaborare == NULL){
+            p->ultimoDaElaborare = NULL;
+        }
+        pthread_mutex_unlock(&p->mutex);
+
+        // Il buffer di uscita viene dimensionato sul numero di righe (e ingrandito nei rari casi in cui non basti)
+        size_t numRighe = 1;
+        for(const char *c = b->testo; (c = memchr(c, '\n', (size_t)(b->testo + b->lenTesto - c))) != NULL; c++){
+            numRighe++;
+        }
+        b->out.capacita = numRighe * (LEN_CF + 1);
+        b->out.dati = malloc(b->out.capacita);
+        if(b->out.dati != NULL){
+            ElaboraTesto(b->testo, b->lenTesto, p->operazione, &b->out, p->fileScarti != NULL ? &b->scarti : NULL);
+        }
+
+        pthread_mutex_lock(&p->mutex);
+        if(b->out.dati == NULL || b->out.erroreAllocazione || b->scarti.erroreAllocazione){
+            p->erroreAllocazione = true;
+        }
+        p->completati[b->sequenza % MAX_BLOCCHI_IN_VOLO] = b;
+        pthread_cond_signal(&p->bloccoCompletato);
+        pthread_mutex_unlock(&p->mutex);
+    }
+}
+
+// Thread di scrittura: scrive i risultati dei blocchi rispettando l'ordine delle righe in ingresso
+static void* ThreadScrittura(void *arg){
+    pipeline *p = arg;
+    while(true){
+        pthread_mutex_lock(&p->mutex);
+        blocco *b;
+        while((b = p->completati[p->numScritti % MAX_BLOCCHI_IN_VOLO]) == NULL
+              && !(p->letturaConclusa && p->numScritti == p->numLetti)){
+            pthread_cond_wait(&p->bloccoCompletato, &p->mutex);
+        }
+        if(b == NULL){
+            pthread_mutex_unlock(&p->mutex);
+            return NULL;
+        }
+        p->completati[p->numScritti % MAX_BLOCCHI_IN_VOLO] = NULL;
+        p->numScritti++;
+        p->numRecord += b->out.numRecord;
+        p->numErrori += b->out.numErrori;
+        pthread_cond_signal(&p->spazioDisponibile);
+        pthread_mutex_unlock(&p->mutex);
+
+        if(b->out.dati != NULL){
+            MISURA_FASE(FASE_SCRITTURA, fwrite(b->out.dati, 1, b->out.len, p->file));
+        }
+        if(b->scarti.dati != NULL){
+            fwrite(b->scarti.dati, 1, b->scarti.len, p->fileScarti);
+        }
+        LiberaBlocco(b);
+    }
+}
+
+// Accoda un blocco letto alla lista dei blocchi da elaborare attendendo se troppi blocchi sono ancora in sospeso
+static void AccodaBlocco(pipeline *p, blocco *b){
+    pthread_mutex_lock(&p->mutex);
+    while(p->numLetti - p->numScritti >= MAX_BLOCCHI_IN_VOLO){
+        pthread_cond_wait(&p->spazioDisponibile, &p->mutex);
+    }
+    b->sequenza = p->numLetti++;
+    if(p->ultimoDaElaborare == NULL){
+        p->primoDaElaborare = b;
+    }
+    else{
+        p->ultimoDaElaborare->successivo = b;
+    }
+    p->ultimoDaElaborare = b;
+    pthread_cond_signal(&p->lavoroDisponibile);
+    pthread_mutex_unlock(&p->mutex);
+}
+
+// Crea un nuovo blocco copiandovi l'eventuale riga incompleta rimasta dal blocco precedente
+static blocco* NuovoBlocco(const char resto[], size_t lenResto){
+    blocco *b = calloc(1, sizeof(blocco));
+    if(b == NULL){
+        return NULL;
+    }
+    b->testo = malloc(lenResto + LEN_BLOCCO_BATCH + 1);
+    if(b->testo == NULL){
+        free(b);
+        return NULL;
+    }
+    memcpy(b->testo, resto, lenResto);
+    b->lenTesto = lenResto;
+    return b;
+}
+
+// Elaborazione parallela: il thread principale legge l'input e lo suddivide in blocchi di righe complete,
+// numThread thread calcolano i codici fiscali e un thread dedicato scrive i risultati nell'ordine originale
+static int ElaboraParallelo(FILE *input, FILE *fileScarti, int numThread, elaboraRecord operazione){
+    pipeline p;
+    memset(&p, 0, sizeof(p));
+    pthread_mutex_init(&p.mutex, NULL);
+    pthread_cond_init(&p.lavoroDisponibile, NULL);
+    pthread_cond_init(&p.bloccoCompletato, NULL);
+    pthread_cond_init(&p.spazioDisponibile, NULL);
+    p.file = stdout;
+    p.fileScarti = fileScarti;
+    p.operazione = operazione;
+
+    pthread_t *calcolo = malloc((size_t)numThread * sizeof(pthread_t));
+    if(calcolo == NULL){
+        return ERR_ALLOCAZIONE;
+    }
+    // Se non è possibile creare tutti i thread l'input non viene letto e i thread già creati vengono conclusi come al
+    // termine dell'elaborazione, senza alcun blocco da elaborare
+    pthread_t scrittura;
+    bool scritturaAvviata = pthread_create(&scrittura, NULL, ThreadScrittura, &p) == 0;
+    int numAvviati = 0;
+    while(scritturaAvviata && numAvviati < numThread
+          && pthread_create(&calcolo[numAvviati], NULL, ThreadCalcolo, &p) == 0){
+        numAvviati++;
+    }
+    bool avviata = scritturaAvviata && numAvviati == numThread;
+
+    blocco *b = avviata ? NuovoBlocco(NULL, 0) : NULL;
+    while(b != NULL){
+        size_t letti = fread(b->testo + b->lenTesto, 1, LEN_BLOCCO_BATCH, input);
+        bool fineFile = letti == 0;
+        b->lenTesto += letti;
+
+        // Il blocco termina con l'ultima riga completa: la parte restante passa al blocco successivo.
+        // Un blocco privo di righe complete viene elaborato per intero
+        size_t lenRighe = b->lenTesto;
+        if(!fineFile){
+            while(lenRighe > 0 && b->testo[lenRighe - 1] != '\n'){
+                lenRighe--;
+            }
+            if(lenRighe == 0){
+                lenRighe = b->lenTesto;
+            }
+        }
+        blocco *successivo = NULL;
+        if(!fineFile){
+            successivo = NuovoBlocco(b->testo + lenRighe, b->lenTesto - lenRighe);
+            if(successivo == NULL){
+                // Lo stesso campo viene scritto dai thread di calcolo: l'accesso è protetto dallo stesso mutex
+                pthread_mutex_lock(&p.mutex);
+                p.erroreAllocazione = true;
+                pthread_mutex_unlock(&p.mutex);
+            }
+        }
+        b->lenTesto = lenRighe;
+        if(b->lenTesto > 0){
+            AccodaBlocco(&p, b);
+        }
+        else{
+            LiberaBlocco(b);
+        }
+        b = successivo;
+    }
+
+    pthread_mutex_lock(&p.mutex);
+    p.letturaConclusa = true;
+    pthread_cond_broadcast(&p.lavoroDisponibile);
+    pthread_cond_broadcast(&p.bloccoCompletato);
+    pthread_mutex_unlock(&p.mutex);
+    for(int i=0; i<numAvviati; i++){
+        pthread_join(calcolo[i], NULL);
+    }
+    if(scritturaAvviata){
+        pthread_join(scrittura, NULL);
+    }
+    fflush(p.file);
+    if(fileScarti != NULL){
+        fflush(fileScarti);
+    }
+    free(calcolo);
+
+    pthread_mutex_destroy(&p.mutex);
+    pthread_cond_destroy(&p.lavoroDisponibile);
+    pthread_cond_destroy(&p.bloccoCompletato);
+    pthread_cond_destroy(&p.spazioDisponibile);
+
+    if(!avviata){
+        return ERR_THREAD;
+    }
+    if(p.erroreAllocazione){
+        return ERR_ALLOCAZIONE;
+    }
+    StampaRiepilogo(fileScarti, p.numRecord, p.numErrori);
+    return 0;
+}
+
+int ModalitaBatch(const char nomeFileInput[], const char nomeFileScarti[], int numThread, int operazione){
+    // Il catalogo viene caricato prima di avviare l'elaborazione (ed eventualmente i thread) in modo da segnalare
+    // subito l'eventuale assenza del file e da condividerlo in sola lettura
+    if(CatalogoCondiviso() == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", FILE_CODICI_CATASTALI);
+        return ERR_CATALOGO;
+    }
+    // Il catalogo storico è facoltativo: viene solo caricato, se presente, prima dell'avvio dei thread
+    CatalogoStoricoCondiviso();
+
+    FILE *input = ApriInput(nomeFileInput);
+    if(input == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", nomeFileInput);
+        return ERR_FILE_INPUT;
+    }
+
+    // Nella validazione i record non validi vengono separati da quelli validi
+    FILE *fileScarti = NULL;
+    if(operazione == BATCH_VALIDAZIONE){
+        fileScarti = stderr;
+        if(nomeFileScarti != NULL){
+            fileScarti = fopen(nomeFileScarti, "wb");
+            if(fileScarti == NULL){
+                fprintf(stderr, "ERRORE FATALE. Impossibile scrivere il file %s.\n", nomeFileScarti);
+                if(input != stdin){
+                    fclose(input);
+                }
+                return ERR_FILE_USCITA;
+            }
+        }
+    }
+
+    elaboraRecord funzione = CodificaRecord;
+    if(operazione == BATCH_DECODIFICA || operazione == BATCH_VALIDAZIONE){
+        funzione = operazione == BATCH_DECODIFICA ? DecodificaRecord : ValidaRecord;
+        time_t adesso = time(NULL);
+        annoRiferimento = localtime(&adesso)->tm_year + 1900;
+    }
+
+    int errore;
+    if(numThread > 1){
+        errore = ElaboraParallelo(input, fileScarti, numThread, funzione);
+    }
+    else{
+        errore = ElaboraSequenziale(input, fileScarti, funzione);
+    }
+    if(errore == ERR_ALLOCAZIONE){
+        fprintf(stderr, "ERRORE FATALE. Allocazione fallita.\n");
+    }
+    else if(errore == ERR_THREAD){
+        fprintf(stderr, "ERRORE FATALE. Impossibile creare i thread di elaborazione.\n");
+    }
+
+    if(input != stdin){
+        fclose(input);
+    }
+    if(fileScarti != NULL && fileScarti != stderr){
+        fclose(fileScarti);
+    }
+    return errore;
+}
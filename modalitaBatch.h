@@ -0,0 +1,31 @@
+#ifndef MODALITA_BATCH_H
+#define MODALITA_BATCH_H
+
+#include "codificaCF.h"
+
+/* MODULO: Elaborazione non interattiva di un flusso di record
+ * Nella codifica ogni riga in ingresso ha il formato "nome;cognome;sesso;gg/mm/aaaa;luogo di nascita" (è ammesso anche
+ * il carattere di tabulazione come separatore) e per ogni riga viene scritto in uscita il codice fiscale.
+ * Nella decodifica ogni riga contiene un codice fiscale e in uscita viene scritto "codice;sesso;gg/mm/aaaa;luogo".
+ * In caso di errore viene scritto "ERRORE;<codice>" in modo che le righe in uscita corrispondano a quelle in ingresso.
+ * Nella validazione ogni riga contiene un codice fiscale: i codici validi vengono riportati su standard output, mentre
+ * quelli non validi vengono scritti nel flusso degli scarti nel formato "codice;esito;descrizione".
+ * Nella modalità parallela un thread legge l'input a blocchi di righe complete, un gruppo di thread calcola i codici
+ * e un thread dedicato scrive i risultati dei blocchi nell'ordine di lettura.
+ */
+
+// Dimensione dei blocchi di lettura e del buffer di scrittura
+#define LEN_BLOCCO_BATCH (1 << 20)
+
+// Operazioni eseguibili sui record
+#define BATCH_CODIFICA 0
+#define BATCH_DECODIFICA 1
+#define BATCH_VALIDAZIONE 2
+
+// Elabora il file indicato (oppure lo standard input se il nome è NULL o "-") scrivendo i risultati su standard output.
+// Nella validazione i codici non validi vengono scritti nel file nomeFileScarti (standard error se NULL).
+// Con numThread maggiore di 1 il calcolo viene distribuito su più thread mantenendo l'ordine delle righe in uscita.
+// Restituisce 0 in caso di successo oppure il codice di errore
+int ModalitaBatch(const char nomeFileInput[], const char nomeFileScarti[], int numThread, int operazione);
+
+#endif
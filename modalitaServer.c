@@ -0,0 +1,447 @@
+// accept4 è un'estensione GNU
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "catalogoComuni.h"
+#include "catalogoStorico.h"
+#include "codiciErrore.h"
+#include "codificaCF.h"
+#include "modalitaBatch.h"
+#include "modalitaServer.h"
+#include "strumentazione.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Numero massimo di eventi restituiti da una singola attesa
+#define MAX_EVENTI 64
+
+// Comandi del protocollo (seguiti da uno spazio e dai dati della richiesta)
+#define CMD_CODIFICA "ENCODE"
+#define CMD_VALIDAZIONE "VALIDATE"
+
+// Lunghezza massima di una singola risposta (escluso il carattere di fine riga)
+#define LEN_MAX_RISPOSTA 128
+
+// Stato di una connessione: richieste ricevute non ancora complete e risposte non ancora inviate
+typedef struct CONNESSIONE {
+    int fd;
+    char ingresso[LEN_BUFFER_SERVER + 1];
+    size_t lenIngresso;
+    char *uscita;
+    size_t lenUscita;
+    size_t capacitaUscita;
+    size_t inviati;          // Byte di uscita già inviati
+    bool letturaSospesa;     // La lettura è sospesa finché le risposte in attesa non vengono inviate
+    bool chiusuraRichiesta;  // Il client ha concluso l'invio: la connessione viene chiusa dopo l'ultima risposta
+    struct CONNESSIONE *precedente, *successiva;  // Elenco delle connessioni aperte del thread
+}connessione;
+
+// Stato condiviso dai thread del servizio
+typedef struct SERVER {
+    int ascolto;             // Socket in ascolto
+    int fine;                // Evento che segnala a tutti i thread la conclusione del servizio
+    int annoRiferimento;     // Anno a cui si riferisce la validazione delle due cifre dell'anno di nascita
+}server;
+
+// Accoda una risposta (con fine riga) al buffer di uscita della connessione. Restituisce false se manca la memoria
+static bool Rispondi(connessione *c, const char risposta[], size_t len){
+    if(c->lenUscita + len + 1 > c->capacitaUscita){
+        size_t capacita = 2 * c->capacitaUscita + len + 1;
+        char *uscita = realloc(c->uscita, capacita);
+        if(uscita == NULL){
+            return false;
+        }
+        c->uscita = uscita;
+        c->capacitaUscita = capacita;
+    }
+    memcpy(c->uscita + c->lenUscita, risposta, len);
+    c->uscita[c->lenUscita + len] = '\n';
+    c->lenUscita += len + 1;
+    return true;
+}
+
+// Restituisce i dati della richiesta se la riga inizia con il comando indicato seguito da uno spazio, NULL altrimenti
+static char* DatiComando(char riga[], const char comando[]){
+    size_t len = strlen(comando);
+    if(strncmp(riga, comando, len) != 0 || riga[len] != ' '){
+        return NULL;
+    }
+    return riga + len + 1;
+}
+
+// Elabora una richiesta completa (priva del carattere di fine riga) e ne accoda la risposta.
+// Restituisce false se manca la memoria
+static bool ElaboraRichiesta(const server *s, connessione *c, char riga[], size_t len){
+    char risposta[LEN_MAX_RISPOSTA];
+    int lenRisposta;
+
+    // Ignoro il carattere '\r' dei client che terminano le righe in formato Windows
+    if(len > 0 && riga[len - 1] == '\r'){
+        len--;
+    }
+    if(len == 0){
+        return true;
+    }
+    riga[len] = '\0';
+
+    char *dati;
+    if((dati = DatiComando(riga, CMD_CODIFICA)) != NULL){
+        persona persona;
+        char codiceFiscale[LEN_CF + 1];
+        int errore;
+        MISURA_FASE(FASE_LETTURA, errore = LeggiPersona(dati, &persona));
+        if(errore == 0){
+            errore = CodificaPersona(&persona, codiceFiscale);
+        }
+        if(errore == 0){
+            lenRisposta = snprintf(risposta, sizeof(risposta), "OK;%s", codiceFiscale);
+        }
+        else{
+            lenRisposta = snprintf(risposta, sizeof(risposta), "ERRORE;%d", errore);
+        }
+    }
+    else if((dati = DatiComando(riga, CMD_VALIDAZIONE)) != NULL){
+        size_t lenCodice = strlen(dati);
+        MaiuscoloCodiceFiscale(dati, lenCodice);
+        int esito = ValidaCodiceFiscale(dati, lenCodice, s->annoRiferimento);
+        if(esito == CF_VALIDO){
+            lenRisposta = snprintf(risposta, sizeof(risposta), "OK");
+        }
+        else{
+            lenRisposta = snprintf(risposta, sizeof(risposta), "ERRORE;%d;%s", esito, DESCRIZIONE_ESITO_CF[esito]);
+        }
+    }
+    else{
+        // Comando sconosciuto
+        lenRisposta = snprintf(risposta, sizeof(risposta), "ERRORE;%d", ERR_DATI);
+    }
+    if(lenRisposta >= (int)sizeof(risposta)){
+        lenRisposta = sizeof(risposta) - 1;
+    }
+    return Rispondi(c, risposta, (size_t)lenRisposta);
+}
+
+// Elabora tutte le richieste complete presenti nel buffer di lettura spostando all'inizio l'eventuale richiesta
+// incompleta. Se il client ha concluso l'invio viene elaborata anche l'ultima richiesta priva di fine riga.
+// Restituisce false se manca la memoria
+static bool ElaboraIngresso(const server *s, connessione *c){
+    char *riga = c->ingresso, *fine = c->ingresso + c->lenIngresso, *fineRiga;
+    while((fineRiga = memchr(riga, '\n', (size_t)(fine - riga))) != NULL){
+        if(!ElaboraRichiesta(s, c, riga, (size_t)(fineRiga - riga))){
+            return false;
+        }
+        riga = fineRiga + 1;
+    }
+    if(c->chiusuraRichiesta && riga < fine){
+        if(!ElaboraRichiesta(s, c, riga, (size_t)(fine - riga))){
+            return false;
+        }
+        riga = fine;
+    }
+    c->lenIngresso = (size_t)(fine - riga);
+    memmove(c->ingresso, riga, c->lenIngresso);
+    return true;
+}
+
+// Invia le risposte in attesa finché il socket lo consente. Restituisce false se la connessione è stata interrotta
+static bool InviaUscita(connessione *c){
+    while(c->inviati < c->lenUscita){
+        ssize_t inviati;
+        MISURA_FASE(FASE_SCRITTURA, inviati = send(c->fd, c->uscita + c->inviati, c->lenUscita - c->inviati,
+                                                   MSG_NOSIGNAL));
+        if(inviati < 0){
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        c->inviati += (size_t)inviati;
+    }
+    c->lenUscita = 0;
+    c->inviati = 0;
+    return true;
+}
+
+// Legge le richieste disponibili e le elabora. Restituisce false se la connessione deve essere chiusa
+static bool LeggiConnessione(const server *s, connessione *c){
+    ssize_t letti = recv(c->fd, c->ingresso + c->lenIngresso, LEN_BUFFER_SERVER - c->lenIngresso, 0);
+    if(letti < 0){
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if(letti == 0){
+        c->chiusuraRichiesta = true;
+    }
+    c->lenIngresso += (size_t)letti;
+    if(!ElaboraIngresso(s, c)){
+        return false;
+    }
+    // Una richiesta che occupa l'intero buffer senza fine riga è troppo lunga: la connessione viene chiusa
+    return c->lenIngresso < LEN_BUFFER_SERVER;
+}
+
+// Aggiorna gli eventi attesi sulla connessione: la lettura è sospesa se troppe risposte sono in attesa o se il client
+// ha concluso l'invio, la scrittura viene attesa solo se vi sono risposte da inviare
+static void AggiornaEventi(int epoll, connessione *c){
+    struct epoll_event evento = {0, {.ptr = c}};
+    c->letturaSospesa = c->lenUscita - c->inviati >= LIMITE_USCITA_SERVER || c->chiusuraRichiesta;
+    if(!c->letturaSospesa){
+        evento.events |= EPOLLIN;
+    }
+    if(c->inviati < c->lenUscita){
+        evento.events |= EPOLLOUT;
+    }
+    epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &evento);
+}
+
+// Chiude la connessione, la rimuove dall'elenco delle connessioni aperte del thread e ne libera la memoria
+static void ChiudiConnessione(int epoll, connessione **aperte, connessione *c){
+    if(c->precedente != NULL){
+        c->precedente->successiva = c->successiva;
+    }
+    else{
+        *aperte = c->successiva;
+    }
+    if(c->successiva != NULL){
+        c->successiva->precedente = c->precedente;
+    }
+    epoll_ctl(epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->uscita);
+    free(c);
+}
+
+// Accetta tutte le connessioni in attesa registrandole nell'istanza epoll e nell'elenco delle connessioni del thread
+static void AccettaConnessioni(const server *s, int epoll, connessione **aperte){
+    int fd;
+    while((fd = accept4(s->ascolto, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0){
+        connessione *c = malloc(sizeof(connessione));
+        if(c == NULL){
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->lenIngresso = 0;
+        c->uscita = NULL;
+        c->lenUscita = c->capacitaUscita = c->inviati = 0;
+        c->letturaSospesa = c->chiusuraRichiesta = false;
+        struct epoll_event evento = {EPOLLIN, {.ptr = c}};
+        if(epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &evento) != 0){
+            close(fd);
+            free(c);
+            continue;
+        }
+        c->precedente = NULL;
+        c->successiva = *aperte;
+        if(*aperte != NULL){
+            (*aperte)->precedente = c;
+        }
+        *aperte = c;
+    }
+}
+
+// Thread del servizio: ogni thread attende nuove connessioni sul socket condiviso (il kernel risveglia un solo thread
+// per ogni connessione) e gestisce quelle che ha accettato fino alla loro chiusura
+static void* ThreadServer(void *arg){
+    const server *s = arg;
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll < 0){
+        return NULL;
+    }
+    // Il socket in ascolto è individuato dal puntatore NULL e l'evento di conclusione dal puntatore allo stato comune
+    struct epoll_event evento = {EPOLLIN | EPOLLEXCLUSIVE, {.ptr = NULL}};
+    epoll_ctl(epoll, EPOLL_CTL_ADD, s->ascolto, &evento);
+    evento = (struct epoll_event){EPOLLIN, {.ptr = (void*)s}};
+    epoll_ctl(epoll, EPOLL_CTL_ADD, s->fine, &evento);
+
+    struct epoll_event eventi[MAX_EVENTI];
+    connessione *aperte = NULL;
+    bool attivo = true;
+    while(attivo){
+        int numEventi = epoll_wait(epoll, eventi, MAX_EVENTI, -1);
+        for(int i=0; i<numEventi; i++){
+            if(eventi[i].data.ptr == NULL){
+                AccettaConnessioni(s, epoll, &aperte);
+                continue;
+            }
+            if(eventi[i].data.ptr == s){
+                attivo = false;
+                continue;
+            }
+            connessione *c = eventi[i].data.ptr;
+            bool aperta = true;
+            if(eventi[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)){
+                aperta = LeggiConnessione(s, c);
+            }
+            if(aperta){
+                aperta = InviaUscita(c);
+            }
+            // La connessione si chiude quando il client ha concluso l'invio e tutte le risposte sono state inviate
+            if(!aperta || (c->chiusuraRichiesta && c->lenUscita == 0)){
+                ChiudiConnessione(epoll, &aperte, c);
+            }
+            else{
+                AggiornaEventi(epoll, c);
+            }
+        }
+    }
+    // Le connessioni ancora aperte vengono chiuse dal thread che le ha accettate, con le eventuali risposte non inviate
+    while(aperte != NULL){
+        ChiudiConnessione(epoll, &aperte, aperte);
+    }
+    close(epoll);
+    return NULL;
+}
+
+// Controlla se un servizio è in ascolto sul socket indicato tentando di connettersi. Un socket rimasto da
+// un'esecuzione conclusa rifiuta la connessione. Nel dubbio il servizio viene considerato attivo
+static bool SocketAttivo(const struct sockaddr_un *indirizzo){
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        return true;
+    }
+    // Con la coda delle connessioni piena la connessione non viene completata, ma il servizio è comunque attivo
+    bool attivo = connect(fd, (const struct sockaddr*)indirizzo, sizeof(*indirizzo)) == 0
+                  || (errno != ECONNREFUSED && errno != ENOENT);
+    close(fd);
+    return attivo;
+}
+
+// Crea il socket in ascolto sul percorso indicato. Restituisce il descrittore oppure -1 in caso di errore
+static int ApriSocket(const char percorsoSocket[]){
+    struct sockaddr_un indirizzo;
+    memset(&indirizzo, 0, sizeof(indirizzo));
+    indirizzo.sun_family = AF_UNIX;
+    if(strlen(percorsoSocket) >= sizeof(indirizzo.sun_path)){
+        return -1;
+    }
+    strcpy(indirizzo.sun_path, percorsoSocket);
+
+    // Un socket rimasto da un'esecuzione precedente viene sostituito, ma un file che non è un socket oppure il socket
+    // di un servizio ancora in esecuzione non vengono mai cancellati
+    struct stat info;
+    if(lstat(percorsoSocket, &info) == 0){
+        if(!S_ISSOCK(info.st_mode)){
+            fprintf(stderr, "ERRORE. Il percorso %s esiste e non è un socket.\n", percorsoSocket);
+            return -1;
+        }
+        if(SocketAttivo(&indirizzo)){
+            fprintf(stderr, "ERRORE. Un altro servizio è in ascolto sul socket %s.\n", percorsoSocket);
+            return -1;
+        }
+        unlink(percorsoSocket);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        return -1;
+    }
+    if(bind(fd, (struct sockaddr*)&indirizzo, sizeof(indirizzo)) != 0 || listen(fd, SOMAXCONN) != 0){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ModalitaServer(const char percorsoSocket[], int numThread){
+    // Il catalogo viene caricato prima di avviare il servizio e resta residente per tutta la sua durata
+    if(CatalogoCondiviso() == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", FILE_CODICI_CATASTALI);
+        return ERR_CATALOGO;
+    }
+    CatalogoStoricoCondiviso();
+    if(numThread < 1){
+        numThread = 1;
+    }
+
+    // I segnali vengono gestiti unicamente dal thread principale, che li attende in modo sincrono: i thread creati
+    // in seguito ereditano la maschera e non vengono mai interrotti
+    sigset_t segnali;
+    sigemptyset(&segnali);
+    sigaddset(&segnali, SIGHUP);
+    sigaddset(&segnali, SIGINT);
+    sigaddset(&segnali, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &segnali, NULL);
+
+    server s;
+    time_t adesso = time(NULL);
+    s.annoRiferimento = localtime(&adesso)->tm_year + 1900;
+    s.ascolto = ApriSocket(percorsoSocket);
+    s.fine = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pthread_t *thread = malloc((size_t)numThread * sizeof(pthread_t));
+    if(s.ascolto < 0 || s.fine < 0 || thread == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile avviare il servizio sul socket %s.\n", percorsoSocket);
+        if(s.ascolto >= 0){
+            close(s.ascolto);
+            unlink(percorsoSocket);
+        }
+        if(s.fine >= 0){
+            close(s.fine);
+        }
+        free(thread);
+        return thread == NULL ? ERR_ALLOCAZIONE : ERR_SERVER;
+    }
+    // Se non è possibile creare tutti i thread il servizio non viene avviato e i thread già creati vengono conclusi
+    int numAvviati = 0;
+    while(numAvviati < numThread && pthread_create(&thread[numAvviati], NULL, ThreadServer, &s) == 0){
+        numAvviati++;
+    }
+    bool avviato = numAvviati == numThread;
+    if(avviato){
+        fprintf(stderr, "Servizio attivo sul socket %s con %d thread.\n", percorsoSocket, numThread);
+    }
+    else{
+        fprintf(stderr, "ERRORE FATALE. Impossibile creare i thread del servizio.\n");
+    }
+
+    int segnale;
+    while(avviato && sigwait(&segnali, &segnale) == 0 && segnale == SIGHUP){
+        // La ricarica avviene mentre i thread continuano a rispondere con il catalogo precedente
+        if(RicaricaCatalogo(FILE_CODICI_CATASTALI, FILE_CODICI_ESTERI) == 0){
+            fprintf(stderr, "Catalogo ricaricato.\n");
+        }
+        else{
+            fprintf(stderr, "ERRORE. Impossibile ricaricare il file %s: resta in uso il catalogo precedente.\n",
+                    FILE_CODICI_CATASTALI);
+        }
+    }
+
+    // L'evento di conclusione resta segnalato e risveglia tutti i thread
+    uint64_t uno = 1;
+    if(write(s.fine, &uno, sizeof(uno)) < 0){
+        fprintf(stderr, "ERRORE. Impossibile concludere il servizio.\n");
+    }
+    for(int i=0; i<numAvviati; i++){
+        pthread_join(thread[i], NULL);
+    }
+    free(thread);
+    close(s.ascolto);
+    close(s.fine);
+    unlink(percorsoSocket);
+    if(!avviato){
+        return ERR_SERVER;
+    }
+    fprintf(stderr, "Servizio concluso.\n");
+    return 0;
+}
+
+#else
+
+int ModalitaServer(const char percorsoSocket[], int numThread){
+    (void)numThread;
+    fprintf(stderr, "ERRORE FATALE. Il servizio sul socket %s è disponibile solo su Linux.\n", percorsoSocket);
+    return ERR_SERVER;
+}
+
+#endif
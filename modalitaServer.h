@@ -0,0 +1,25 @@
+#ifndef MODALITA_SERVER_H
+#define MODALITA_SERVER_H
+
+/* MODULO: Servizio residente su socket di dominio Unix
+ * Il processo carica il catalogo una sola volta e risponde alle richieste dei client, una per riga:
+ *      ENCODE nome;cognome;sesso;gg/mm/aaaa;luogo di nascita  ->  "OK;<codice fiscale>" oppure "ERRORE;<codice>"
+ *      VALIDATE codice fiscale                                ->  "OK" oppure "ERRORE;<esito>;<descrizione>"
+ * Ad ogni riga non vuota corrisponde esattamente una risposta, nello stesso ordine: un client può quindi inviare
+ * molte richieste consecutive senza attendere le singole risposte (pipelining).
+ * Ogni thread del servizio gestisce le proprie connessioni con epoll e socket non bloccanti. Il segnale SIGHUP
+ * ricarica il catalogo senza interrompere il servizio, mentre SIGINT e SIGTERM lo concludono.
+ * Disponibile solo su Linux.
+ */
+
+// Dimensione del buffer di lettura di ogni connessione, che limita anche la lunghezza di una richiesta
+#define LEN_BUFFER_SERVER (1 << 16)
+
+// Quantità di risposte in attesa di invio oltre la quale la lettura delle richieste di una connessione viene sospesa
+#define LIMITE_USCITA_SERVER (1 << 20)
+
+// Avvia il servizio sul socket indicato (eventualmente sostituendo un socket preesistente) con numThread thread e lo
+// esegue fino alla ricezione di SIGINT o SIGTERM. Restituisce 0 in caso di successo oppure il codice di errore
+int ModalitaServer(const char percorsoSocket[], int numThread);
+
+#endif
@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "catalogoComuni.h"
+#include "codiciErrore.h"
+#include "ricercaComuni.h"
+
+// Numero iniziale di nodi allocati per l'albero
+#define NODI_INIZIALI 4096
+
+// Risultati raccolti durante la visita dell'albero
+typedef struct RACCOLTA {
+    suggerimento *risultati;
+    size_t numRisultati;
+    size_t maxRisultati;
+    int distanzaMax;
+}raccolta;
+
+// Restituisce il figlio del nodo corrispondente al carattere indicato, creandolo se non esiste.
+// I figli sono mantenuti in ordine alfabetico. Restituisce 0 in caso di errore di allocazione
+static uint32_t Figlio(indiceComuni *indice, uint32_t nodo, unsigned char carattere){
+    uint32_t precedente = 0, corrente = indice->nodi[nodo].primoFiglio;
+    while(corrente != 0 && indice->nodi[corrente].carattere < carattere){
+        precedente = corrente;
+        corrente = indice->nodi[corrente].fratello;
+    }
+    if(corrente != 0 && indice->nodi[corrente].carattere == carattere){
+        return corrente;
+    }
+
+    if(indice->numNodi == indice->capacita){
+        uint32_t capacita = 2 * indice->capacita;
+        nodoTrie *nodi = realloc(indice->nodi, capacita * sizeof(nodoTrie));
+        if(nodi == NULL){
+            return 0;
+        }
+        indice->nodi = nodi;
+        indice->capacita = capacita;
+    }
+    uint32_t nuovo = indice->numNodi++;
+    indice->nodi[nuovo] = (nodoTrie){0, corrente, 0, carattere};
+    if(precedente == 0){
+        indice->nodi[nodo].primoFiglio = nuovo;
+    }
+    else{
+        indice->nodi[precedente].fratello = nuovo;
+    }
+    return nuovo;
+}
+
+int CostruisciIndiceComuni(indiceComuni *indice, const catalogo *cat){
+    indice->cat = cat;
+    indice->capacita = NODI_INIZIALI;
+    indice->numNodi = 1;
+    indice->nodi = malloc(indice->capacita * sizeof(nodoTrie));
+    if(indice->nodi == NULL){
+        return ERR_ALLOCAZIONE;
+    }
+    indice->nodi[0] = (nodoTrie){0, 0, 0, 0};
+
+    for(uint32_t i=0; i<cat->numComuni; i++){
+        const comune *c = &cat->comuni[i];
+        uint32_t nodo = 0;
+        for(uint32_t j=0; j<c->lenChiave; j++){
+            nodo = Figlio(indice, nodo, (unsigned char)c->chiave[j]);
+            if(nodo == 0){
+                LiberaIndiceComuni(indice);
+                return ERR_ALLOCAZIONE;
+            }
+        }
+        if(nodo == 0){
+            continue;
+        }
+        // In caso di chiavi ripetute prevale la prima occorrenza, come nella ricerca esatta
+        if(indice->nodi[nodo].comune == 0){
+            indice->nodi[nodo].comune = i + 1;
+        }
+    }
+    return 0;
+}
+
+// Accoda i comuni contenuti nel sottoalbero del nodo in ordine alfabetico finché c'è spazio nei risultati
+static void RaccogliSottoalbero(const indiceComuni *indice, uint32_t nodo, const comune *risultati[],
+                                size_t *numRisultati, size_t maxRisultati){
+    if(indice->nodi[nodo].comune != 0 && *numRisultati < maxRisultati){
+        risultati[(*numRisultati)++] = &indice->cat->comuni[indice->nodi[nodo].comune - 1];
+    }
+    for(uint32_t f = indice->nodi[nodo].primoFiglio; f != 0 && *numRisultati < maxRisultati; f = indice->nodi[f].fratello){
+        RaccogliSottoalbero(indice, f, risultati, numRisultati, maxRisultati);
+    }
+}
+
+size_t CompletaComune(const indiceComuni *indice, const char prefisso[], size_t lenPrefisso,
+                      const comune *risultati[], size_t maxRisultati){
+    char chiave[LEN_MAX_CHIAVE];
+    size_t lenChiave = NormalizzaNome(prefisso, lenPrefisso, chiave);
+    if(lenChiave == 0){
+        return 0;
+    }
+    uint32_t nodo = 0;
+    for(size_t i=0; i<lenChiave; i++){
+        unsigned char carattere = (unsigned char)chiave[i];
+        uint32_t f = indice->nodi[nodo].primoFiglio;
+        while(f != 0 && indice->nodi[f].carattere < carattere){
+            f = indice->nodi[f].fratello;
+        }
+        if(f == 0 || indice->nodi[f].carattere != carattere){
+            return 0;
+        }
+        nodo = f;
+    }
+    size_t numRisultati = 0;
+    RaccogliSottoalbero(indice, nodo, risultati, &numRisultati, maxRisultati);
+    return numRisultati;
+}
+
+// Inserisce un comune tra i risultati mantenendoli ordinati per distanza (a parità di distanza resta l'ordine
+// alfabetico di visita). Quando i risultati sono completi la distanza massima viene ridotta di conseguenza
+static void AggiungiSuggerimento(raccolta *r, const comune *c, int distanza){
+    size_t pos = r->numRisultati;
+    if(pos == r->maxRisultati){
+        pos--;
+    }
+    while(pos > 0 && r->risultati[pos - 1].distanza > distanza){
+        r->risultati[pos] = r->risultati[pos - 1];
+        pos--;
+    }
+    r->risultati[pos] = (suggerimento){c, distanza};
+    if(r->numRisultati < r->maxRisultati){
+        r->numRisultati++;
+    }
+    if(r->numRisultati == r->maxRisultati){
+        r->distanzaMax = r->risultati[r->numRisultati - 1].distanza - 1;
+    }
+}
+
+// Visita il sottoalbero del nodo calcolando la riga della matrice delle distanze relativa al prefisso del nodo a
+// partire da quella del nodo padre
+static void VisitaDistanza(const indiceComuni *indice, uint32_t nodo, const unsigned char nome[], size_t lenNome,
+                           const int rigaPadre[], raccolta *r){
+    int riga[LEN_MAX_CHIAVE + 1];
+    unsigned char carattere = indice->nodi[nodo].carattere;
+    int minimo = riga[0] = rigaPadre[0] + 1;
+    for(size_t j=1; j<=lenNome; j++){
+        int inserimento = riga[j - 1] + 1;
+        int cancellazione = rigaPadre[j] + 1;
+        int sostituzione = rigaPadre[j - 1] + (nome[j - 1] != carattere);
+        int d = inserimento < cancellazione ? inserimento : cancellazione;
+        riga[j] = d < sostituzione ? d : sostituzione;
+        if(riga[j] < minimo){
+            minimo = riga[j];
+        }
+    }
+
+    if(indice->nodi[nodo].comune != 0 && riga[lenNome] <= r->distanzaMax){
+        AggiungiSuggerimento(r, &indice->cat->comuni[indice->nodi[nodo].comune - 1], riga[lenNome]);
+    }
+    // Nessun nome che prosegue questo prefisso può avere una distanza inferiore al minimo della riga
+    if(minimo > r->distanzaMax){
+        return;
+    }
+    for(uint32_t f = indice->nodi[nodo].primoFiglio; f != 0; f = indice->nodi[f].fratello){
+        VisitaDistanza(indice, f, nome, lenNome, riga, r);
+    }
+}
+
+size_t SuggerisciComuni(const indiceComuni *indice, const char nome[], size_t lenNome, int distanzaMax,
+                        suggerimento risultati[], size_t maxRisultati){
+    char cercato[LEN_MAX_CHIAVE];
+    int riga[LEN_MAX_CHIAVE + 1];
+    size_t lenCercato = NormalizzaNome(nome, lenNome, cercato);
+    if(lenCercato == 0 || maxRisultati == 0){
+        return 0;
+    }
+    for(size_t j=0; j<=lenCercato; j++){
+        riga[j] = (int)j;
+    }
+
+    raccolta r = {risultati, 0, maxRisultati, distanzaMax};
+    for(uint32_t f = indice->nodi[0].primoFiglio; f != 0; f = indice->nodi[f].fratello){
+        VisitaDistanza(indice, f, (const unsigned char*)cercato, lenCercato, riga, &r);
+    }
+    return r.numRisultati;
+}
+
+void LiberaIndiceComuni(indiceComuni *indice){
+    free(indice->nodi);
+    memset(indice, 0, sizeof(*indice));
+}
@@ -0,0 +1,56 @@
+#ifndef RICERCA_COMUNI_H
+#define RICERCA_COMUNI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "catalogoComuni.h"
+
+/* MODULO: Ricerca approssimata dei comuni per nome
+ * Le chiavi normalizzate dei comuni del catalogo vengono inserite in un albero di prefissi (trie) in cui ogni nodo
+ * corrisponde ad un carattere. L'albero consente di completare un nome a partire dalle sue prime lettere e di
+ * suggerire i comuni il cui nome differisce da quello cercato per al più DISTANZA_MAX_SUGGERIMENTI operazioni
+ * (inserimento, cancellazione o sostituzione di un carattere): la distanza viene calcolata una sola volta per ogni
+ * prefisso comune a più nomi e i rami che non possono più rientrare nella distanza massima vengono scartati.
+ */
+
+// Distanza massima (di Levenshtein) tra il nome cercato e i comuni suggeriti
+#define DISTANZA_MAX_SUGGERIMENTI 2
+
+typedef struct NODO_TRIE {
+    uint32_t primoFiglio;  // Indice del primo figlio (0 se il nodo non ha figli)
+    uint32_t fratello;     // Indice del fratello successivo in ordine alfabetico (0 se assente)
+    uint32_t comune;       // Indice del comune + 1 se il nodo conclude una chiave, 0 altrimenti
+    unsigned char carattere;
+}nodoTrie;
+
+typedef struct INDICE_COMUNI {
+    const catalogo *cat;
+    nodoTrie *nodi;        // Il nodo 0 è la radice
+    uint32_t numNodi;
+    uint32_t capacita;
+}indiceComuni;
+
+typedef struct SUGGERIMENTO {
+    const comune *comune;
+    int distanza;
+}suggerimento;
+
+// Costruisce l'indice dei nomi dei comuni presenti nel catalogo. Restituisce 0 in caso di successo oppure il codice di
+// errore
+int CostruisciIndiceComuni(indiceComuni *indice, const catalogo *cat);
+
+// Scrive in risultati (in ordine alfabetico) al più maxRisultati comuni la cui chiave inizia con quella del prefisso
+// indicato. Restituisce il numero di comuni trovati
+size_t CompletaComune(const indiceComuni *indice, const char prefisso[], size_t lenPrefisso,
+                      const comune *risultati[], size_t maxRisultati);
+
+// Scrive in risultati al più maxRisultati comuni la cui chiave dista al più distanzaMax da quella del nome cercato,
+// ordinati per distanza crescente. Restituisce il numero di comuni trovati
+size_t SuggerisciComuni(const indiceComuni *indice, const char nome[], size_t lenNome, int distanzaMax,
+                        suggerimento risultati[], size_t maxRisultati);
+
+// Libera la memoria occupata dall'indice
+void LiberaIndiceComuni(indiceComuni *indice);
+
+#endif
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <signal.h>
+
+#include "codiciErrore.h"
+#include "strumentazione.h"
+
+// Ogni potenza di 2 di nanosecondi è suddivisa in 2^BITS_SOTTOCLASSI classi: le durate inferiori a SOTTOCLASSI
+// nanosecondi hanno una classe per ogni valore e quelle oltre 2^ESPONENTE_MAX nanosecondi (circa 18 minuti) ricadono
+// nell'ultima classe
+#define BITS_SOTTOCLASSI 4
+#define SOTTOCLASSI (1 << BITS_SOTTOCLASSI)
+#define ESPONENTE_MAX 39
+#define NUM_CLASSI ((ESPONENTE_MAX - BITS_SOTTOCLASSI + 2) * SOTTOCLASSI)
+
+// Nomi delle fasi nel risultato
+static const char *const NOME_FASE[NUM_FASI] = {
+    "LeggiPersona", "CodificaNome", "CodificaCognome", "CodificaDataNascita", "CercaCodiceCatastale", "CalcolaCIN",
+    "Scrittura"
+};
+
+// Contatori di una fase. Ogni thread scrive solo i propri, quindi gli incrementi non richiedono istruzioni atomiche
+// di lettura e scrittura: le operazioni atomiche rilassate servono solo a rendere lecita la lettura concorrente
+// da parte di ScriviStrumentazione
+typedef struct CONTATORI_FASE {
+    _Atomic uint64_t esecuzioni;
+    _Atomic uint64_t totale;
+    _Atomic uint64_t massimo;
+    _Atomic uint64_t classi[NUM_CLASSI];
+}contatoriFase;
+
+// Contatori di un thread, collegati nell'elenco di tutti i thread che hanno eseguito almeno una fase. Non vengono mai
+// liberati, in modo che i risultati dei thread già conclusi restino disponibili
+typedef struct CONTATORI_THREAD {
+    contatoriFase fasi[NUM_FASI];
+    struct CONTATORI_THREAD *successivo;
+}contatoriThread;
+
+static _Thread_local contatoriThread *contatoriLocali = NULL;
+static _Atomic(contatoriThread*) elencoThread = NULL;
+
+// Impedisce che due scritture (alla conclusione e su segnale) si sovrappongano
+static pthread_mutex_t mutexScrittura = PTHREAD_MUTEX_INITIALIZER;
+
+// Restituisce la classe dell'istogramma a cui appartiene una durata
+static int ClasseDurata(uint64_t durata){
+    if(durata < SOTTOCLASSI){
+        return (int)durata;
+    }
+    int esponente = 63 - __builtin_clzll(durata);
+    if(esponente > ESPONENTE_MAX){
+        return NUM_CLASSI - 1;
+    }
+    return (esponente - BITS_SOTTOCLASSI + 1) * SOTTOCLASSI
+           + (int)((durata >> (esponente - BITS_SOTTOCLASSI)) & (SOTTOCLASSI - 1));
+}
+
+// Restituisce la durata minima appartenente ad una classe (l'inverso di ClasseDurata)
+static uint64_t InizioClasse(int classe){
+    if(classe < SOTTOCLASSI){
+        return (uint64_t)classe;
+    }
+    int esponente = classe / SOTTOCLASSI + BITS_SOTTOCLASSI - 1;
+    return (uint64_t)(SOTTOCLASSI + classe % SOTTOCLASSI) << (esponente - BITS_SOTTOCLASSI);
+}
+
+// Incrementa un contatore scritto solo dal thread chiamante
+static inline void Incrementa(_Atomic uint64_t *contatore, uint64_t valore){
+    atomic_store_explicit(contatore, atomic_load_explicit(contatore, memory_order_relaxed) + valore,
+                          memory_order_relaxed);
+}
+
+void RegistraFase(int fase, uint64_t durata){
+    contatoriThread *locali = contatoriLocali;
+    if(locali == NULL){
+        // Alla prima fase eseguita dal thread i suoi contatori vengono aggiunti all'elenco
+        locali = calloc(1, sizeof(contatoriThread));
+        if(locali == NULL){
+            return;
+        }
+        locali->successivo = atomic_load(&elencoThread);
+        while(!atomic_compare_exchange_weak(&elencoThread, &locali->successivo, locali)){
+        }
+        contatoriLocali = locali;
+    }
+    contatoriFase *c = &locali->fasi[fase];
+    Incrementa(&c->esecuzioni, 1);
+    Incrementa(&c->totale, durata);
+    Incrementa(&c->classi[ClasseDurata(durata)], 1);
+    if(durata > atomic_load_explicit(&c->massimo, memory_order_relaxed)){
+        atomic_store_explicit(&c->massimo, durata, memory_order_relaxed);
+    }
+}
+
+// Restituisce il limite superiore della classe in cui ricade la frazione indicata delle esecuzioni
+static uint64_t Percentile(const uint64_t classi[NUM_CLASSI], uint64_t esecuzioni, uint64_t massimo, double frazione){
+    uint64_t soglia = (uint64_t)(frazione * (double)esecuzioni + 0.5), cumulate = 0;
+    if(soglia == 0){
+        soglia = 1;
+    }
+    for(int i=0; i<NUM_CLASSI; i++){
+        cumulate += classi[i];
+        if(cumulate >= soglia){
+            uint64_t limite = i + 1 < NUM_CLASSI ? InizioClasse(i + 1) - 1 : massimo;
+            return limite < massimo ? limite : massimo;
+        }
+    }
+    return massimo;
+}
+
+int ScriviStrumentazione(FILE *file){
+    static uint64_t classi[NUM_CLASSI];
+    pthread_mutex_lock(&mutexScrittura);
+    int numThread = 0;
+    for(contatoriThread *t = atomic_load(&elencoThread); t != NULL; t = t->successivo){
+        numThread++;
+    }
+    fprintf(file, "{\n  \"thread\": %d,\n  \"fasi\": [", numThread);
+    for(int f=0; f<NUM_FASI; f++){
+        // Somma dei contatori di tutti i thread: i thread ancora attivi possono registrare altre esecuzioni durante
+        // la lettura, quindi i totali di una fase possono differire di qualche unità dalla somma dell'istogramma
+        uint64_t esecuzioni = 0, totale = 0, massimo = 0;
+        for(int i=0; i<NUM_CLASSI; i++){
+            classi[i] = 0;
+        }
+        for(contatoriThread *t = atomic_load(&elencoThread); t != NULL; t = t->successivo){
+            contatoriFase *c = &t->fasi[f];
+            esecuzioni += atomic_load_explicit(&c->esecuzioni, memory_order_relaxed);
+            totale += atomic_load_explicit(&c->totale, memory_order_relaxed);
+            uint64_t massimoThread = atomic_load_explicit(&c->massimo, memory_order_relaxed);
+            massimo = massimoThread > massimo ? massimoThread : massimo;
+            for(int i=0; i<NUM_CLASSI; i++){
+                classi[i] += atomic_load_explicit(&c->classi[i], memory_order_relaxed);
+            }
+        }
+
+        fprintf(file, "%s\n    {\"fase\": \"%s\", \"esecuzioni\": %llu, \"ns_totali\": %llu, \"ns_op\": %.2f",
+                f == 0 ? "" : ",", NOME_FASE[f], (unsigned long long)esecuzioni, (unsigned long long)totale,
+                esecuzioni > 0 ? (double)totale / (double)esecuzioni : 0.0);
+        fprintf(file, ", \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu",
+                (unsigned long long)Percentile(classi, esecuzioni, massimo, 0.5),
+                (unsigned long long)Percentile(classi, esecuzioni, massimo, 0.9),
+                (unsigned long long)Percentile(classi, esecuzioni, massimo, 0.99),
+                (unsigned long long)Percentile(classi, esecuzioni, massimo, 0.999), (unsigned long long)massimo);
+        // Istogramma: coppie [durata minima della classe, esecuzioni] per le sole classi non vuote
+        fprintf(file, ", \"istogramma\": [");
+        bool prima = true;
+        for(int i=0; i<NUM_CLASSI; i++){
+            if(classi[i] > 0){
+                fprintf(file, "%s[%llu, %llu]", prima ? "" : ", ", (unsigned long long)InizioClasse(i),
+                        (unsigned long long)classi[i]);
+                prima = false;
+            }
+        }
+        fprintf(file, "]}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    int errore = fflush(file) != 0 ? ERR_FILE_USCITA : 0;
+    pthread_mutex_unlock(&mutexScrittura);
+    return errore;
+}
+
+// Scrive i contatori alla conclusione del programma
+static void ScriviStrumentazioneFinale(void){
+    ScriviStrumentazione(stderr);
+}
+
+// Thread dedicato al segnale SIGUSR1: ad ogni ricezione scrive i contatori
+static void* ThreadSegnale(void *arg){
+    const sigset_t *segnali = arg;
+    int segnale;
+    while(sigwait(segnali, &segnale) == 0){
+        ScriviStrumentazione(stderr);
+    }
+    return NULL;
+}
+
+int AvviaStrumentazione(void){
+    static sigset_t segnali;
+    sigemptyset(&segnali);
+    sigaddset(&segnali, SIGUSR1);
+    // Il segnale viene bloccato nel thread chiamante e quindi in tutti quelli creati in seguito, in modo che venga
+    // ricevuto soltanto dal thread dedicato
+    pthread_sigmask(SIG_BLOCK, &segnali, NULL);
+    pthread_t thread;
+    if(pthread_create(&thread, NULL, ThreadSegnale, &segnali) != 0){
+        return ERR_THREAD;
+    }
+    pthread_detach(thread);
+    return atexit(ScriviStrumentazioneFinale) == 0 ? 0 : ERR_ALLOCAZIONE;
+}
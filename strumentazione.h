@@ -0,0 +1,64 @@
+#ifndef STRUMENTAZIONE_H
+#define STRUMENTAZIONE_H
+
+/* MODULO: Misura facoltativa dei tempi delle fasi del calcolo
+ * Con l'opzione STRUMENTAZIONE di CMake ogni fase racchiusa in MISURA_FASE incrementa i contatori del thread che la
+ * esegue: numero di esecuzioni, tempo totale e massimo e istogramma delle durate con classi di ampiezza crescente
+ * (16 classi per ogni potenza di 2 di nanosecondi, quindi con un errore relativo inferiore al 7%, come negli
+ * istogrammi HDR). I contatori dei thread vengono sommati solo al momento della scrittura in formato JSON, che avviene
+ * alla conclusione del programma e ad ogni ricezione del segnale SIGUSR1 (vedi AvviaStrumentazione).
+ * Senza l'opzione MISURA_FASE si riduce alla sola istruzione misurata e il modulo non viene compilato.
+ */
+
+// Fasi misurate
+#define FASE_LETTURA 0          // Interpretazione di un record (LeggiPersona)
+#define FASE_NOME 1             // Codifica del nome
+#define FASE_COGNOME 2          // Codifica del cognome
+#define FASE_DATA 3             // Codifica della data di nascita e del sesso
+#define FASE_CODICE_CATASTALE 4 // Ricerca del codice catastale del luogo di nascita
+#define FASE_CIN 5              // Calcolo del carattere di controllo
+#define FASE_SCRITTURA 6        // Scrittura dei risultati su file o su socket
+#define NUM_FASI 7
+
+#ifdef STRUMENTAZIONE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Esegue l'istruzione (anche un'assegnazione) e ne registra la durata nei contatori della fase
+#define MISURA_FASE(fase, ...) do{ \
+        uint64_t inizioFase = IstanteStrumentazione(); \
+        __VA_ARGS__; \
+        RegistraFase((fase), IstanteStrumentazione() - inizioFase); \
+    }while(0)
+
+// Restituisce l'istante attuale in nanosecondi (orologio monotono)
+static inline uint64_t IstanteStrumentazione(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+// Aggiunge una durata in nanosecondi ai contatori della fase relativi al thread chiamante
+void RegistraFase(int fase, uint64_t durata);
+
+// Scrive sul file i contatori di tutti i thread sommati fase per fase, in formato JSON.
+// Restituisce 0 in caso di successo oppure ERR_FILE_USCITA
+int ScriviStrumentazione(FILE *file);
+
+// Scrive i contatori sullo standard error alla conclusione del programma e ad ogni segnale SIGUSR1, gestito da un
+// thread dedicato. Deve essere chiamata prima di creare altri thread, che ereditano il blocco del segnale.
+// Restituisce 0 in caso di successo, ERR_THREAD se il thread non può essere creato oppure ERR_ALLOCAZIONE se non è
+// possibile registrare la scrittura finale
+int AvviaStrumentazione(void);
+
+#else
+
+#define MISURA_FASE(fase, ...) do{ \
+        __VA_ARGS__; \
+    }while(0)
+
+#endif
+
+#endif
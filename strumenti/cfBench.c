@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../catalogoComuni.h"
+#include "../codiciErrore.h"
+#include "../codificaCF.h"
+#include "../modalitaBatch.h"
+
+/* PROGRAMMA: Misura delle prestazioni delle singole fasi del calcolo del codice fiscale
+ * Genera un insieme di record sintetici (nomi e cognomi da un piccolo corpus, date casuali e luoghi di nascita estratti
+ * dal catalogo generato da codiciCatastali.csv) e misura separatamente ogni fase della codifica, la ricerca del codice
+ * catastale a catalogo già in memoria (caldo) e a partire dalla lettura del file (freddo) e la lettura e la codifica
+ * di un record già in memoria (LeggiPersona e CodificaPersona, senza l'input/output della modalità batch).
+ * Misura infine la modalità batch completa (ModalitaBatch con un solo thread e con più thread) su un file temporaneo
+ * contenente tanti record quante sono le operazioni per fase, con i risultati scritti su /dev/null.
+ * Il generatore casuale ha un seme fisso, quindi i record sono identici ad ogni esecuzione e i risultati di commit
+ * diversi sono confrontabili.
+ * I risultati vengono scritti su standard output in formato JSON, con nanosecondi per operazione e operazioni al
+ * secondo per ogni fase.
+ * UTILIZZO: cf_bench [numero di operazioni per fase] [codiciCatastali.csv] [thread della modalità batch]
+ */
+
+// Numero predefinito di operazioni misurate per ogni fase
+#define OPERAZIONI_PREDEFINITE 1000000L
+
+// Numero di record sintetici distinti (potenza di 2), riutilizzati ciclicamente durante le misure
+#define NUM_RECORD_DATASET (1 << 16)
+
+// Numero di caricamenti del catalogo da file misurati nella ricerca a freddo
+#define RIPETIZIONI_FREDDO 5
+
+// Numero predefinito di thread della misura parallela della modalità batch
+#define THREAD_BATCH_PREDEFINITI 4
+
+// Seme del generatore casuale
+#define SEME_DATASET 0x9E3779B97F4A7C15u
+
+// Dimensioni dei campi dei record sintetici
+#define LEN_CAMPO_BENCH 64
+#define LEN_LUOGO_BENCH 160
+#define LEN_RIGA_BENCH 320
+
+// Corpus dei nomi e dei cognomi utilizzati nei record sintetici
+static const char *const CORPUS_NOMI[] = {
+    "Mario", "Luigi", "Giuseppe", "Giovanni", "Francesco", "Antonio", "Alessandro", "Andrea", "Marco", "Matteo",
+    "Lorenzo", "Luca", "Paolo", "Stefano", "Davide", "Simone", "Ugo", "Ivo", "Ali", "Edoardo",
+    "Maria", "Anna", "Giulia", "Francesca", "Chiara", "Sara", "Laura", "Valentina", "Elena", "Alessia",
+    "Martina", "Federica", "Ilaria", "Eva", "Ada", "Aurora", "Beatrice", "Ginevra", "Noemi", "Ludovica"
+};
+static const char *const CORPUS_COGNOMI[] = {
+    "Rossi", "Russo", "Ferrari", "Esposito", "Bianchi", "Romano", "Colombo", "Ricci", "Marino", "Greco",
+    "Bruno", "Gallo", "Conti", "Costa", "Giordano", "Mancini", "Rizzo", "Lombardi", "Moretti", "Barbieri",
+    "Fontana", "Santoro", "Mariani", "Rinaldi", "Caruso", "Ferrara", "Galli", "Martini", "Leone", "Longo",
+    "Gentile", "Martinelli", "Vitale", "Lombardo", "Serra", "Coppola", "Fo", "Re", "Oe", "Porta"
+};
+#define NUM_CORPUS_NOMI (sizeof(CORPUS_NOMI) / sizeof(CORPUS_NOMI[0]))
+#define NUM_CORPUS_COGNOMI (sizeof(CORPUS_COGNOMI) / sizeof(CORPUS_COGNOMI[0]))
+
+typedef struct RECORD_BENCH {
+    char nome[LEN_CAMPO_BENCH];
+    char cognome[LEN_CAMPO_BENCH];
+    char sesso;
+    data dataNascita;
+    char luogoNascita[LEN_LUOGO_BENCH];
+    char riga[LEN_RIGA_BENCH];        // Record completo nel formato della modalità batch
+    char parziale[LEN_CF];            // Primi 15 caratteri del codice fiscale, con terminatore
+}recordBench;
+
+// Fase misurata: esegue il numero di operazioni indicato e restituisce un valore di controllo che dipende dai
+// risultati, in modo che il compilatore non possa eliminare il calcolo
+typedef uint64_t (*faseBench)(long numOperazioni);
+
+static recordBench *dataset;
+static const char *fileCatalogo = FILE_CODICI_CATASTALI;
+
+// Generatore pseudocasuale xorshift64*
+static uint64_t statoCasuale = SEME_DATASET;
+static uint32_t Casuale(uint32_t limite){
+    statoCasuale ^= statoCasuale >> 12;
+    statoCasuale ^= statoCasuale << 25;
+    statoCasuale ^= statoCasuale >> 27;
+    return (uint32_t)((statoCasuale * 2685821657736338717u) >> 32) % limite;
+}
+
+// Restituisce l'istante attuale in nanosecondi
+static double Adesso(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+// Genera i record sintetici. Restituisce 0 in caso di successo oppure il codice di errore
+static int GeneraDataset(void){
+    const catalogo *cat = CatalogoCondiviso();
+    if(cat == NULL){
+        return ERR_CATALOGO;
+    }
+    dataset = malloc(NUM_RECORD_DATASET * sizeof(recordBench));
+    if(dataset == NULL){
+        return ERR_ALLOCAZIONE;
+    }
+    for(int i=0; i<NUM_RECORD_DATASET; i++){
+        recordBench *r = &dataset[i];
+        strcpy(r->nome, CORPUS_NOMI[Casuale(NUM_CORPUS_NOMI)]);
+        strcpy(r->cognome, CORPUS_COGNOMI[Casuale(NUM_CORPUS_COGNOMI)]);
+        r->sesso = Casuale(2) ? 'F' : 'M';
+        r->dataNascita.anno = ANNO_MIN + 30 + (int)Casuale(80);
+        r->dataNascita.mese = 1 + (int)Casuale(12);
+        r->dataNascita.giorno = 1 + (int)Casuale((uint32_t)GiorniNelMese(r->dataNascita.mese, r->dataNascita.anno));
+
+        // Il luogo di nascita è un comune (o uno stato estero) del catalogo, con la provincia se indicata
+        persona p = {r->nome, r->cognome, r->sesso, r->dataNascita, r->luogoNascita};
+        char codiceFiscale[LEN_CF + 1];
+        do{
+            const comune *c = &cat->comuni[Casuale(cat->numComuni)];
+            if(c->provincia[0] != ' '){
+                snprintf(r->luogoNascita, LEN_LUOGO_BENCH, "%.*s (%.2s)", (int)c->lenNome, c->nome, c->provincia);
+            }
+            else{
+                snprintf(r->luogoNascita, LEN_LUOGO_BENCH, "%.*s", (int)c->lenNome, c->nome);
+            }
+        }while(CodificaPersona(&p, codiceFiscale) != 0);
+        memcpy(r->parziale, codiceFiscale, LEN_CF - 1);
+        r->parziale[LEN_CF - 1] = '\0';
+        snprintf(r->riga, LEN_RIGA_BENCH, "%s;%s;%c;%02d/%02d/%04d;%s", r->nome, r->cognome, r->sesso,
+                 r->dataNascita.giorno, r->dataNascita.mese, r->dataNascita.anno, r->luogoNascita);
+    }
+    return 0;
+}
+
+static uint64_t FaseCodificaNome(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        char *codice = CodificaNome(dataset[i & (NUM_RECORD_DATASET - 1)].nome);
+        if(codice != NULL){
+            controllo += (unsigned char)codice[0];
+        }
+        free(codice);
+    }
+    return controllo;
+}
+
+static uint64_t FaseCodificaCognome(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        char *codice = CodificaCognome(dataset[i & (NUM_RECORD_DATASET - 1)].cognome);
+        if(codice != NULL){
+            controllo += (unsigned char)codice[0];
+        }
+        free(codice);
+    }
+    return controllo;
+}
+
+static uint64_t FaseCodificaDataNascita(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        const recordBench *r = &dataset[i & (NUM_RECORD_DATASET - 1)];
+        char *codice = CodificaDataNascita(r->dataNascita, r->sesso);
+        if(codice != NULL){
+            controllo += (unsigned char)codice[2];
+        }
+        free(codice);
+    }
+    return controllo;
+}
+
+static uint64_t FaseCalcolaCIN(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        controllo += (unsigned char)CalcolaCIN(dataset[i & (NUM_RECORD_DATASET - 1)].parziale);
+    }
+    return controllo;
+}
+
+static uint64_t FaseCalcolaCarattereControllo(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        controllo += (unsigned char)CalcolaCarattereControllo(dataset[i & (NUM_RECORD_DATASET - 1)].parziale);
+    }
+    return controllo;
+}
+
+// Ricerca a caldo: il catalogo condiviso è già in memoria
+static uint64_t FaseCodiceCatastaleCaldo(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        const recordBench *r = &dataset[i & (NUM_RECORD_DATASET - 1)];
+        char codice[LEN_COD_CATASTALE];
+        if(CercaCodiceCatastale(r->luogoNascita, r->dataNascita, codice) == 0){
+            controllo += (unsigned char)codice[3];
+        }
+    }
+    return controllo;
+}
+
+// Ricerca a freddo: ogni operazione legge e indicizza il file dei comuni prima di cercare il luogo di nascita
+static uint64_t FaseCodiceCatastaleFreddo(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        catalogo cat;
+        if(CaricaCatalogo(&cat, fileCatalogo, NULL) != 0){
+            return 0;
+        }
+        CostruisciHashPerfetto(&cat);
+        const char *luogo = dataset[i & (NUM_RECORD_DATASET - 1)].luogoNascita;
+        const comune *c;
+        if(CercaComuneUnivoco(&cat, luogo, strlen(luogo), &c) == 0){
+            controllo += (unsigned char)c->codice[3];
+        }
+        LiberaCatalogo(&cat);
+    }
+    return controllo;
+}
+
+// Lettura dei campi di una riga già in memoria, ricerca del luogo e calcolo del codice: non comprende la lettura del
+// file dei record e la scrittura dei codici della modalità batch
+static uint64_t FaseLeggiCodificaPersona(long numOperazioni){
+    uint64_t controllo = 0;
+    for(long i=0; i<numOperazioni; i++){
+        char riga[LEN_RIGA_BENCH], codiceFiscale[LEN_CF + 1];
+        persona p;
+        strcpy(riga, dataset[i & (NUM_RECORD_DATASET - 1)].riga);
+        if(LeggiPersona(riga, &p) == 0 && CodificaPersona(&p, codiceFiscale) == 0){
+            controllo += (unsigned char)codiceFiscale[POS_CIN];
+        }
+    }
+    return controllo;
+}
+
+// Scrive il risultato di una fase misurata
+static void ScriviRisultato(const char nome[], long numOperazioni, double durata, bool prima){
+    printf("%s\n    {\"fase\": \"%s\", \"operazioni\": %ld, \"ns_op\": %.2f, \"record_s\": %.0f}", prima ? "" : ",", nome,
+           numOperazioni, durata / (double)numOperazioni, (double)numOperazioni * 1e9 / durata);
+}
+
+// Esegue una fase senza misurarla (per portare dati e codice in cache) e poi la misura, scrivendone il risultato
+static uint64_t MisuraFase(const char nome[], faseBench fase, long numOperazioni, bool prima){
+    long riscaldamento = numOperazioni < NUM_RECORD_DATASET ? numOperazioni : NUM_RECORD_DATASET;
+    uint64_t controllo = fase(riscaldamento);
+    double inizio = Adesso();
+    controllo += fase(numOperazioni);
+    ScriviRisultato(nome, numOperazioni, Adesso() - inizio, prima);
+    return controllo;
+}
+
+// Scrive nel file temporaneo indicato il numero di record richiesto, riutilizzando ciclicamente i record sintetici.
+// Restituisce 0 in caso di successo oppure il codice di errore
+static int ScriviFileRecord(char nomeFile[], long numRecord){
+    int fd = mkstemp(nomeFile);
+    FILE *file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if(file == NULL){
+        if(fd >= 0){
+            close(fd);
+            remove(nomeFile);
+        }
+        return ERR_FILE_USCITA;
+    }
+    bool scritto = true;
+    for(long i=0; i<numRecord && scritto; i++){
+        scritto = fprintf(file, "%s\n", dataset[i & (NUM_RECORD_DATASET - 1)].riga) >= 0;
+    }
+    if(fclose(file) != 0 || !scritto){
+        remove(nomeFile);
+        return ERR_FILE_USCITA;
+    }
+    return 0;
+}
+
+// Misura la codifica dell'intero file dei record con la modalità batch, dalla lettura del file alla scrittura dei
+// codici. Lo standard output viene temporaneamente rediretto su /dev/null, in modo da non mescolare i codici ai
+// risultati; il file è appena stato scritto e viene letto dalla cache del sistema operativo
+static void MisuraBatch(const char nome[], const char nomeFile[], long numRecord, int numThread){
+    int fdNullo = open("/dev/null", O_WRONLY);
+    if(fdNullo < 0){
+        fprintf(stderr, "ATTENZIONE. /dev/null non disponibile: fase %s non misurata.\n", nome);
+        return;
+    }
+    fflush(stdout);
+    int fdStandard = dup(STDOUT_FILENO);
+    dup2(fdNullo, STDOUT_FILENO);
+    close(fdNullo);
+    double inizio = Adesso();
+    int errore = ModalitaBatch(nomeFile, NULL, numThread, BATCH_CODIFICA);
+    double durata = Adesso() - inizio;
+    fflush(stdout);
+    dup2(fdStandard, STDOUT_FILENO);
+    close(fdStandard);
+    if(errore != 0){
+        fprintf(stderr, "ATTENZIONE. Errore %d della modalità batch: fase %s non misurata.\n", errore, nome);
+        return;
+    }
+    ScriviRisultato(nome, numRecord, durata, false);
+}
+
+int main(int argc, char *argv[]) {
+    long numOperazioni = OPERAZIONI_PREDEFINITE;
+    if(argc >= 2){
+        numOperazioni = atol(argv[1]);
+    }
+    if(argc >= 3){
+        fileCatalogo = argv[2];
+    }
+    int numThread = THREAD_BATCH_PREDEFINITI;
+    if(argc >= 4){
+        numThread = atoi(argv[3]);
+    }
+    if(numOperazioni < 1 || numThread < 2){
+        fprintf(stderr, "UTILIZZO: %s [numero di operazioni per fase] [codiciCatastali.csv] "
+                "[thread della modalità batch, almeno 2]\n", argv[0]);
+        return ERR_DATI;
+    }
+    int errore = GeneraDataset();
+    if(errore != 0){
+        fprintf(stderr, "ERRORE FATALE. Impossibile generare i record sintetici.\n");
+        return errore;
+    }
+
+    printf("{\n  \"operazioni_per_fase\": %ld,\n  \"record_distinti\": %d,\n  \"seme\": %llu,\n  \"fasi\": [",
+           numOperazioni, NUM_RECORD_DATASET, (unsigned long long)SEME_DATASET);
+    uint64_t controllo = MisuraFase("CodificaNome", FaseCodificaNome, numOperazioni, true);
+    controllo += MisuraFase("CodificaCognome", FaseCodificaCognome, numOperazioni, false);
+    controllo += MisuraFase("CodificaDataNascita", FaseCodificaDataNascita, numOperazioni, false);
+    controllo += MisuraFase("CalcolaCIN", FaseCalcolaCIN, numOperazioni, false);
+    controllo += MisuraFase("CalcolaCarattereControllo", FaseCalcolaCarattereControllo, numOperazioni, false);
+    controllo += MisuraFase("CercaCodiceCatastale_caldo", FaseCodiceCatastaleCaldo, numOperazioni, false);
+    // La ricerca a freddo è misurata solo se il file dei comuni è disponibile
+    FILE *file = fopen(fileCatalogo, "rb");
+    if(file != NULL){
+        fclose(file);
+        controllo += MisuraFase("CercaCodiceCatastale_freddo", FaseCodiceCatastaleFreddo, RIPETIZIONI_FREDDO, false);
+    }
+    else{
+        fprintf(stderr, "ATTENZIONE. File %s non disponibile: ricerca a freddo non misurata.\n", fileCatalogo);
+    }
+    controllo += MisuraFase("LeggiPersona_CodificaPersona", FaseLeggiCodificaPersona, numOperazioni, false);
+    char nomeFileRecord[] = "/tmp/cfBenchXXXXXX";
+    if(ScriviFileRecord(nomeFileRecord, numOperazioni) == 0){
+        char nome[64];
+        MisuraBatch("ModalitaBatch", nomeFileRecord, numOperazioni, 1);
+        snprintf(nome, sizeof(nome), "ModalitaBatch_%dthread", numThread);
+        MisuraBatch(nome, nomeFileRecord, numOperazioni, numThread);
+        remove(nomeFileRecord);
+    }
+    else{
+        fprintf(stderr, "ATTENZIONE. File temporaneo dei record non scrivibile: modalità batch non misurata.\n");
+    }
+    printf("\n  ],\n  \"controllo\": %llu\n}\n", (unsigned long long)controllo);
+
+    free(dataset);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../catalogoComuni.h"
+#include "../codiciErrore.h"
+
+/* PROGRAMMA: Generatore del catalogo dei comuni incorporato nell'eseguibile
+ * Legge codiciCatastali.csv e codiciStatiEsteri.csv e scrive un sorgente C che contiene i nomi dei comuni e le relative chiavi normalizzate
+ * in due array di caratteri, l'elenco dei comuni con i relativi codici catastali, l'hash perfetto minimo dei nomi e l'indice per codice
+ * catastale. In questo modo il catalogo è disponibile all'avvio del programma senza alcuna lettura o elaborazione
+ * del file.
+ * UTILIZZO: generaCatalogo <codiciCatastali.csv> <codiciStatiEsteri.csv> <file .c di uscita>
+ */
+
+// Numero di valori scritti su ogni riga degli array generati
+#define VALORI_PER_RIGA 12
+
+// Scrive un nome come stringa C, codificando in ottale i caratteri non ASCII e quelli speciali
+static void ScriviStringa(FILE *out, const char testo[], size_t len){
+    fputc('"', out);
+    for(size_t i=0; i<len; i++){
+        unsigned char c = (unsigned char)testo[i];
+        if(c < 0x20 || c >= 0x7F || c == '"' || c == '\\' || c == '?'){
+            fprintf(out, "\\%03o", c);
+        }
+        else{
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int main(int argc, char *argv[]) {
+    if(argc != 4){
+        fprintf(stderr, "UTILIZZO: %s <codiciCatastali.csv> <codiciStatiEsteri.csv> <file .c di uscita>\n", argv[0]);
+        return ERR_DATI;
+    }
+
+    catalogo cat;
+    int errore = CaricaCatalogo(&cat, argv[1], argv[2]);
+    if(errore != 0){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", argv[1]);
+        return errore;
+    }
+    errore = CostruisciHashPerfetto(&cat);
+    if(errore != 0){
+        fprintf(stderr, "ERRORE FATALE. Impossibile costruire l'hash perfetto dei comuni.\n");
+        LiberaCatalogo(&cat);
+        return errore;
+    }
+    if(cat.testoEsteri == NULL){
+        fprintf(stderr, "ATTENZIONE. Il file %s non è leggibile: il catalogo non conterrà gli stati esteri.\n", argv[2]);
+    }
+    FILE *out = fopen(argv[3], "w");
+    if(out == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile scrivere il file %s.\n", argv[3]);
+        LiberaCatalogo(&cat);
+        return ERR_FILE_USCITA;
+    }
+
+    fprintf(out, "// FILE GENERATO AUTOMATICAMENTE DA generaCatalogo A PARTIRE DA codiciCatastali.csv E "
+                 "codiciStatiEsteri.csv: NON MODIFICARE\n\n"
+                 "#include \"catalogoComuni.h\"\n\n");
+
+    // Nomi dei comuni accostati senza separatori
+    size_t lenNomi = 0;
+    fprintf(out, "static const char NOMI[] =\n");
+    for(uint32_t i=0; i<cat.numComuni; i++){
+        fprintf(out, "    ");
+        ScriviStringa(out, cat.comuni[i].nome, cat.comuni[i].lenNome);
+        fprintf(out, "\n");
+        lenNomi += cat.comuni[i].lenNome;
+    }
+    fprintf(out, "    ;\n\n");
+
+    // Chiavi normalizzate dei nomi, accostate allo stesso modo
+    fprintf(out, "static const char CHIAVI[] =\n");
+    for(uint32_t i=0; i<cat.numComuni; i++){
+        fprintf(out, "    ");
+        ScriviStringa(out, cat.comuni[i].chiave, cat.comuni[i].lenChiave);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "    ;\n\n");
+
+    // Elenco dei comuni: ogni nome e ogni chiave sono individuati dalla loro posizione all'interno di NOMI e CHIAVI
+    size_t posNome = 0, posChiave = 0;
+    fprintf(out, "static const comune COMUNI[%u] = {\n", cat.numComuni);
+    for(uint32_t i=0; i<cat.numComuni; i++){
+        const comune *c = &cat.comuni[i];
+        fprintf(out, "    {NOMI + %zu, %u, CHIAVI + %zu, %u, %u, {'%c', '%c', '%c', '%c'}, {'%c', '%c'}},\n", posNome,
+                c->lenNome, posChiave, c->lenChiave, c->omonimo, c->codice[0], c->codice[1], c->codice[2], c->codice[3],
+                c->provincia[0], c->provincia[1]);
+        posNome += c->lenNome;
+        posChiave += c->lenChiave;
+    }
+    fprintf(out, "};\n\n");
+
+    // Hash perfetto minimo: spostamento di ogni gruppo e comune presente in ogni posizione
+    fprintf(out, "static const uint32_t SPOSTAMENTI[%u] = {", cat.numGruppi);
+    for(uint32_t i=0; i<cat.numGruppi; i++){
+        fprintf(out, "%s%u,", i % VALORI_PER_RIGA == 0 ? "\n    " : " ", cat.spostamenti[i]);
+    }
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "static const uint32_t POSIZIONI[%u] = {", cat.numPosizioni);
+    for(uint32_t i=0; i<cat.numPosizioni; i++){
+        fprintf(out, "%s%u,", i % VALORI_PER_RIGA == 0 ? "\n    " : " ", cat.posizioni[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    // Indice inverso per codice catastale
+    fprintf(out, "static const uint16_t PER_CODICE[%d] = {", NUM_CODICI_CATASTALI);
+    for(int i=0; i<NUM_CODICI_CATASTALI; i++){
+        fprintf(out, "%s%u,", i % VALORI_PER_RIGA == 0 ? "\n    " : " ", cat.perCodice[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "const catalogo CATALOGO_COMUNI_INCORPORATO = {\n"
+                 "    NOMI, %zu, false, NULL, 0, false, CHIAVI, COMUNI, %u, NULL, 0, SPOSTAMENTI, %u, POSIZIONI, %u, PER_CODICE\n"
+                 "};\n", lenNomi, cat.numComuni, cat.numGruppi, cat.numPosizioni);
+
+    errore = ferror(out) ? ERR_FILE_USCITA : 0;
+    fclose(out);
+    LiberaCatalogo(&cat);
+    return errore;
+}
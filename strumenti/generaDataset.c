@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "../catalogoComuni.h"
+#include "../codiciErrore.h"
+#include "../codificaCF.h"
+
+/* PROGRAMMA: Generatore di record sintetici per le prove di carico e di regressione della modalità batch
+ * Scrive su standard output il numero richiesto di record nel formato della modalità batch
+ * ("nome;cognome;sesso;gg/mm/aaaa;luogo di nascita"):
+ *  - nomi e cognomi sono composti alternando consonanti e vocali, con un numero di consonanti scelto in modo da
+ *    percorrere tutti i casi della codifica (più di tre consonanti, esattamente tre, meno di tre con vocali in aggiunta);
+ *  - le date sono distribuite tra ANNO_MIN e la data odierna (o la fine dell'anno indicato), compresi i 29 febbraio;
+ *  - i luoghi di nascita sono estratti dal catalogo generato da codiciCatastali.csv, compresi i comuni con nomi
+ *    accentati e quelli omonimi, per i quali viene indicata la provincia.
+ * I record sono suddivisi in blocchi e ogni blocco ha un proprio generatore casuale derivato dal seme e dal numero del
+ * blocco: il risultato dipende quindi solo dal seme e dall'anno massimo, non dal numero di thread. I blocchi vengono
+ * generati in parallelo e scritti nell'ordine.
+ * UTILIZZO: generaDataset <numero di record> [--seme S] [--threads N] [--anno-max A] > record.csv
+ */
+
+// Numero di record di ogni blocco generato da un singolo thread
+#define RECORD_PER_BLOCCO 65536
+
+// Lunghezza massima di un record generato, compreso il fine riga
+#define LEN_MAX_RECORD 256
+
+// Seme predefinito
+#define SEME_PREDEFINITO 20241103u
+
+// Lunghezza massima di nomi e cognomi generati
+#define LEN_MAX_PAROLA 12
+
+static const char CONSONANTI[] = "BCDFGHLMNPRSTVZ";
+static const char VOCALI[] = "AEIOU";
+#define NUM_CONSONANTI (sizeof(CONSONANTI) - 1)
+#define NUM_VOCALI (sizeof(VOCALI) - 1)
+
+// Stato condiviso tra i thread di generazione
+typedef struct GENERATORE {
+    pthread_mutex_t mutex;
+    pthread_cond_t turnoScrittura;
+    uint64_t seme;
+    long numRecord;
+    long numBlocchi;
+    long prossimoBlocco;     // Prossimo blocco da assegnare ad un thread
+    long bloccoDaScrivere;   // Blocco che deve essere scritto per primo
+    int annoMax;
+    int meseMax;             // Ultimo mese e ultimo giorno ammessi nell'anno massimo
+    int giornoMax;
+    const catalogo *cat;
+    bool erroreScrittura;
+}generatore;
+
+// Generatore pseudocasuale splitmix64: ogni blocco parte da uno stato derivato dal seme e dal numero del blocco
+static uint64_t Casuale(uint64_t *stato){
+    uint64_t z = (*stato += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+// Restituisce un numero casuale da 0 a limite - 1
+static uint32_t CasualeLimitato(uint64_t *stato, uint32_t limite){
+    return (uint32_t)(((Casuale(stato) >> 32) * limite) >> 32);
+}
+
+// Scrive una parola con iniziale maiuscola composta da numConsonanti consonanti e da circa altrettante vocali (almeno
+// quante ne servono per raggiungere LEN_MIN_NOME lettere), alternate in modo da risultare pronunciabile.
+// Restituisce la lunghezza della parola
+static size_t ScriviParola(uint64_t *stato, int numConsonanti, char parola[]){
+    int numVocali = (numConsonanti > 1 ? numConsonanti - 1 : 0) + (int)CasualeLimitato(stato, 2);
+    if(numConsonanti + numVocali < LEN_MIN_NOME){
+        numVocali = LEN_MIN_NOME - numConsonanti;
+    }
+    if(numConsonanti + numVocali > LEN_MAX_PAROLA){
+        numVocali = LEN_MAX_PAROLA - numConsonanti;
+    }
+    size_t len = 0;
+    bool vocale = CasualeLimitato(stato, 2) == 0;
+    while(numConsonanti > 0 || numVocali > 0){
+        // Le consonanti possono comparire anche in coppia, come in "Sandro"
+        if((vocale && numVocali > 0) || numConsonanti == 0){
+            parola[len++] = VOCALI[CasualeLimitato(stato, NUM_VOCALI)];
+            numVocali--;
+            vocale = false;
+        }
+        else{
+            parola[len++] = CONSONANTI[CasualeLimitato(stato, NUM_CONSONANTI)];
+            numConsonanti--;
+            vocale = numConsonanti == 0 || CasualeLimitato(stato, 5) != 0;
+        }
+        // Le lettere successive alla prima sono minuscole
+        if(len > 1){
+            parola[len - 1] = (char)(parola[len - 1] - 'A' + 'a');
+        }
+    }
+    return len;
+}
+
+// Sceglie il numero di consonanti di un nome o cognome: i casi da 0 a 2 consonanti (completati con le vocali),
+// esattamente 3 e più di 3 hanno la stessa probabilità
+static int NumeroConsonanti(uint64_t *stato){
+    int caso = (int)CasualeLimitato(stato, 5);
+    return caso < 4 ? caso : 4 + (int)CasualeLimitato(stato, 4);
+}
+
+// Scrive un numero di due o quattro cifre
+static size_t ScriviCifre(char testo[], int valore, int numCifre){
+    for(int i=numCifre - 1; i>=0; i--){
+        testo[i] = (char)('0' + valore % 10);
+        valore /= 10;
+    }
+    return (size_t)numCifre;
+}
+
+// Scrive un record completo nel buffer (con fine riga) e ne restituisce la lunghezza
+static size_t ScriviRecord(const generatore *g, uint64_t *stato, char testo[]){
+    size_t len = ScriviParola(stato, NumeroConsonanti(stato), testo);
+    testo[len++] = DIV_CHAR;
+    len += ScriviParola(stato, NumeroConsonanti(stato), testo + len);
+    testo[len++] = DIV_CHAR;
+    testo[len++] = CasualeLimitato(stato, 2) ? 'F' : 'M';
+    testo[len++] = DIV_CHAR;
+
+    // Data di nascita: l'anno viene scelto per primo, quindi il mese e un giorno valido di quel mese
+    int anno = ANNO_MIN + (int)CasualeLimitato(stato, (uint32_t)(g->annoMax - ANNO_MIN + 1));
+    int mese = 1 + (int)CasualeLimitato(stato, 12);
+    int giorno = 1 + (int)CasualeLimitato(stato, (uint32_t)GiorniNelMese(mese, anno));
+    if(anno == g->annoMax && (mese > g->meseMax || (mese == g->meseMax && giorno > g->giornoMax))){
+        mese = g->meseMax;
+        giorno = g->giornoMax;
+    }
+    len += ScriviCifre(testo + len, giorno, 2);
+    testo[len++] = '/';
+    len += ScriviCifre(testo + len, mese, 2);
+    testo[len++] = '/';
+    len += ScriviCifre(testo + len, anno, 4);
+    testo[len++] = DIV_CHAR;
+
+    // Luogo di nascita: i comuni omonimi sono distinti dalla sigla della provincia
+    const comune *c = &g->cat->comuni[CasualeLimitato(stato, g->cat->numComuni)];
+    size_t lenNome = c->lenNome < LEN_MAX_RECORD / 2 ? c->lenNome : LEN_MAX_RECORD / 2;
+    memcpy(testo + len, c->nome, lenNome);
+    len += lenNome;
+    if(c->provincia[0] != ' '){
+        testo[len++] = ' ';
+        testo[len++] = '(';
+        memcpy(testo + len, c->provincia, LEN_SIGLA_PROVINCIA);
+        len += LEN_SIGLA_PROVINCIA;
+        testo[len++] = ')';
+    }
+    testo[len++] = '\n';
+    return len;
+}
+
+// Thread di generazione: genera i blocchi che gli vengono assegnati e li scrive rispettando il loro ordine
+static void* ThreadGenerazione(void *arg){
+    generatore *g = arg;
+    char *buffer = malloc((size_t)RECORD_PER_BLOCCO * LEN_MAX_RECORD);
+    if(buffer == NULL){
+        pthread_mutex_lock(&g->mutex);
+        g->erroreScrittura = true;
+        pthread_mutex_unlock(&g->mutex);
+        return NULL;
+    }
+    while(true){
+        pthread_mutex_lock(&g->mutex);
+        long blocco = g->prossimoBlocco++;
+        pthread_mutex_unlock(&g->mutex);
+        if(blocco >= g->numBlocchi){
+            break;
+        }
+
+        uint64_t stato = g->seme ^ ((uint64_t)blocco * 0xD1B54A32D192ED03u);
+        long primo = blocco * RECORD_PER_BLOCCO;
+        long numRecord = g->numRecord - primo < RECORD_PER_BLOCCO ? g->numRecord - primo : RECORD_PER_BLOCCO;
+        size_t len = 0;
+        for(long i=0; i<numRecord; i++){
+            len += ScriviRecord(g, &stato, buffer + len);
+        }
+
+        pthread_mutex_lock(&g->mutex);
+        while(g->bloccoDaScrivere != blocco){
+            pthread_cond_wait(&g->turnoScrittura, &g->mutex);
+        }
+        pthread_mutex_unlock(&g->mutex);
+        bool errore = fwrite(buffer, 1, len, stdout) != len;
+        pthread_mutex_lock(&g->mutex);
+        g->erroreScrittura |= errore;
+        g->bloccoDaScrivere++;
+        pthread_cond_broadcast(&g->turnoScrittura);
+        pthread_mutex_unlock(&g->mutex);
+    }
+    free(buffer);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    generatore g;
+    memset(&g, 0, sizeof(g));
+    g.seme = SEME_PREDEFINITO;
+    int numThread = 1;
+    time_t adesso = time(NULL);
+    struct tm *oggi = localtime(&adesso);
+    g.annoMax = oggi->tm_year + 1900;
+    g.meseMax = oggi->tm_mon + 1;
+    g.giornoMax = oggi->tm_mday;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--seme") == 0 && i + 1 < argc){
+            g.seme = strtoull(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc){
+            numThread = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--anno-max") == 0 && i + 1 < argc){
+            // Con un anno fissato i record non dipendono più dalla data di esecuzione
+            g.annoMax = atoi(argv[++i]);
+            g.meseMax = 12;
+            g.giornoMax = 31;
+        }
+        else{
+            g.numRecord = atol(argv[i]);
+        }
+    }
+    if(g.numRecord <= 0 || numThread < 1 || g.annoMax < ANNO_MIN){
+        fprintf(stderr, "UTILIZZO: %s <numero di record> [--seme S] [--threads N] [--anno-max A] > record.csv\n",
+                argv[0]);
+        return ERR_DATI;
+    }
+    g.cat = CatalogoCondiviso();
+    if(g.cat == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", FILE_CODICI_CATASTALI);
+        return ERR_CATALOGO;
+    }
+    g.numBlocchi = (g.numRecord + RECORD_PER_BLOCCO - 1) / RECORD_PER_BLOCCO;
+    // Ogni thread genera almeno un blocco: quelli in più resterebbero senza lavoro
+    if(numThread > g.numBlocchi){
+        numThread = (int)g.numBlocchi;
+    }
+    pthread_mutex_init(&g.mutex, NULL);
+    pthread_cond_init(&g.turnoScrittura, NULL);
+
+    pthread_t *thread = malloc((size_t)numThread * sizeof(pthread_t));
+    if(thread == NULL){
+        return ERR_ALLOCAZIONE;
+    }
+    // I blocchi vengono assegnati ai thread man mano che si liberano, quindi quelli avviati completano comunque la
+    // generazione anche se non è stato possibile crearli tutti
+    int numAvviati = 0;
+    while(numAvviati < numThread && pthread_create(&thread[numAvviati], NULL, ThreadGenerazione, &g) == 0){
+        numAvviati++;
+    }
+    if(numAvviati > 0 && numAvviati < numThread){
+        fprintf(stderr, "ATTENZIONE. Avviati solo %d thread di generazione su %d.\n", numAvviati, numThread);
+    }
+    for(int i=0; i<numAvviati; i++){
+        pthread_join(thread[i], NULL);
+    }
+    free(thread);
+    pthread_mutex_destroy(&g.mutex);
+    pthread_cond_destroy(&g.turnoScrittura);
+
+    if(numAvviati == 0){
+        fprintf(stderr, "ERRORE FATALE. Impossibile creare i thread di generazione.\n");
+        return ERR_THREAD;
+    }
+
+    if(fflush(stdout) != 0 || g.erroreScrittura){
+        fprintf(stderr, "ERRORE FATALE. Impossibile scrivere i record generati.\n");
+        return ERR_FILE_USCITA;
+    }
+    return 0;
+}
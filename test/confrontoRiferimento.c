@@ -0,0 +1,460 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../catalogoComuni.h"
+#include "../catalogoStorico.h"
+#include "../codiciErrore.h"
+#include "../codificaCF.h"
+#include "../modalitaBatch.h"
+#include "riferimento.h"
+
+/* PROGRAMMA: Confronto tra le funzioni ottimizzate della libreria e l'implementazione di riferimento
+ * Genera milioni di casi con un generatore casuale a seme fisso e verifica che le funzioni della libreria producano
+ * esattamente gli stessi caratteri della prima versione del programma (vedi riferimento.h):
+ *  - CodificaNome e CodificaCognome su parole casuali di ogni lunghezza, maiuscole e minuscole, con qualsiasi numero
+ *    di consonanti e di vocali;
+ *  - CodificaDataNascita su tutti i giorni dal 1900 al 2099 per entrambi i sessi;
+ *  - CalcolaCIN, CalcolaCarattereControllo e CalcolaCarattereControlloBlocco (a blocchi di lunghezza non multipla
+ *    dei codici elaborati per iterazione) su sequenze casuali di 15 caratteri dell'alfabeto del codice fiscale;
+ *  - CodificaPersona, ValidaCodiceFiscale (compreso il calcolo vettoriale del carattere di controllo) e
+ *    GeneraVariantiOmocodia su persone casuali nate nei comuni del catalogo, con il codice catastale atteso cercato
+ *    scandendo linearmente i file CSV;
+ *  - CercaCodiceCatastale sui comuni del catalogo storico di prova (test/codiciCatastaliStorici.csv) prima, durante e
+ *    dopo i periodi di validità, per un comune soppresso, uno rinominato, uno che esiste ancora con un codice diverso
+ *    e due omonimi di province diverse;
+ *  - la modalità batch parallela sugli stessi record, le cui righe in uscita devono coincidere con i codici attesi.
+ * Le prime differenze trovate vengono descritte su standard error.
+ * Deve essere eseguito dalla cartella che contiene i file CSV e il catalogo storico di prova.
+ * UTILIZZO: confrontoRiferimento [numero di casi] [seme]
+ * Restituisce 0 se non vi sono differenze, 1 altrimenti.
+ */
+
+// Numero predefinito di casi per le prove sulle singole funzioni (le prove sulle persone ne usano un decimo)
+#define CASI_PREDEFINITI 2000000L
+
+// Seme predefinito del generatore casuale
+#define SEME_PREDEFINITO 20241103u
+
+// Numero di codici per ogni chiamata di CalcolaCarattereControlloBlocco: non è un multiplo di 8, quindi ogni blocco
+// comprende anche i codici elaborati singolarmente
+#define LEN_BLOCCO_CIN 37
+
+// Numero massimo di differenze descritte per ogni prova
+#define MAX_DIFFERENZE_DESCRITTE 10
+
+// Lunghezza massima delle parole generate e dei record della modalità batch
+#define LEN_MAX_PAROLA 16
+#define LEN_MAX_RECORD 256
+
+// Numero di thread della prova sulla modalità batch
+#define THREAD_BATCH 4
+
+// Anno di riferimento per la validazione e anno massimo delle persone generate
+#define ANNO_RIFERIMENTO 2024
+
+// Risultato di una singola prova
+typedef struct PROVA {
+    const char *nome;
+    long casi;
+    long differenze;
+}prova;
+
+// Generatore pseudocasuale splitmix64
+static uint64_t Casuale(uint64_t *stato){
+    uint64_t z = (*stato += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+// Restituisce un numero casuale da 0 a limite - 1
+static uint32_t CasualeLimitato(uint64_t *stato, uint32_t limite){
+    return (uint32_t)(((Casuale(stato) >> 32) * limite) >> 32);
+}
+
+// Registra un caso e ne descrive la differenza (solo per le prime MAX_DIFFERENZE_DESCRITTE)
+static void Confronta(prova *prova, bool uguali, const char ingresso[], const char ottenuto[], const char atteso[]){
+    prova->casi++;
+    if(uguali){
+        return;
+    }
+    if(prova->differenze++ < MAX_DIFFERENZE_DESCRITTE){
+        fprintf(stderr, "DIFFERENZA in %s: ingresso \"%s\", ottenuto \"%s\", atteso \"%s\"\n",
+                prova->nome, ingresso, ottenuto, atteso);
+    }
+}
+
+// Confronta due stringhe restituite dalle funzioni di codifica (NULL se l'allocazione è fallita) e le libera
+static void ConfrontaCodifiche(prova *prova, const char ingresso[], char *ottenuto, char *atteso){
+    bool uguali = ottenuto != NULL && atteso != NULL && strcmp(ottenuto, atteso) == 0;
+    Confronta(prova, uguali, ingresso, ottenuto != NULL ? ottenuto : "(NULL)", atteso != NULL ? atteso : "(NULL)");
+    free(ottenuto);
+    free(atteso);
+}
+
+// Scrive una parola casuale di almeno lenMin lettere: le lettere sono scelte tra tutte quelle dell'alfabeto, in
+// maiuscolo o in minuscolo, con la stessa probabilità per vocali e consonanti in modo da coprire sia le parole con
+// molte consonanti sia quelle che richiedono vocali o caratteri di riempimento
+static void ScriviParolaCasuale(uint64_t *stato, int lenMin, char parola[LEN_MAX_PAROLA + 1]){
+    static const char VOCALI[] = "AEIOU";
+    static const char CONSONANTI[] = "BCDFGHJKLMNPQRSTVWXYZ";
+    int len = lenMin + (int)CasualeLimitato(stato, (uint32_t)(LEN_MAX_PAROLA - lenMin + 1));
+    // Le parole brevi sono più frequenti, come i nomi reali
+    if(CasualeLimitato(stato, 2) == 0){
+        len = lenMin + (int)CasualeLimitato(stato, 4);
+    }
+    for(int i=0; i<len; i++){
+        char lettera;
+        if(CasualeLimitato(stato, 2) == 0){
+            lettera = VOCALI[CasualeLimitato(stato, sizeof(VOCALI) - 1)];
+        }
+        else{
+            lettera = CONSONANTI[CasualeLimitato(stato, sizeof(CONSONANTI) - 1)];
+        }
+        if(CasualeLimitato(stato, 2) == 0){
+            lettera = (char)(lettera - 'A' + 'a');
+        }
+        parola[i] = lettera;
+    }
+    parola[len] = '\0';
+}
+
+// Scrive una data di nascita casuale valida tra ANNO_MIN e annoMax
+static data DataCasuale(uint64_t *stato, int annoMax){
+    data data;
+    data.anno = ANNO_MIN + (int)CasualeLimitato(stato, (uint32_t)(annoMax - ANNO_MIN + 1));
+    data.mese = 1 + (int)CasualeLimitato(stato, NUM_MESI);
+    data.giorno = 1 + (int)CasualeLimitato(stato, (uint32_t)GiorniNelMese(data.mese, data.anno));
+    return data;
+}
+
+// Codifica di nomi e cognomi casuali
+static void ProvaNomi(uint64_t *stato, long numCasi, prova *nomi, prova *cognomi){
+    char parola[LEN_MAX_PAROLA + 1];
+    for(long i=0; i<numCasi; i++){
+        ScriviParolaCasuale(stato, LEN_MIN_NOME, parola);
+        ConfrontaCodifiche(nomi, parola, CodificaNome(parola), CodificaNomeRiferimento(parola));
+        ScriviParolaCasuale(stato, LEN_MIN_COGNOME, parola);
+        ConfrontaCodifiche(cognomi, parola, CodificaCognome(parola), CodificaCognomeRiferimento(parola));
+    }
+}
+
+// Codifica di tutte le date di nascita dal 1900 al 2099 per entrambi i sessi
+static void ProvaDate(prova *date){
+    char ingresso[32];
+    for(int anno=ANNO_MIN; anno<ANNO_MIN + 200; anno++){
+        for(int mese=1; mese<=NUM_MESI; mese++){
+            for(int giorno=1; giorno<=GiorniNelMese(mese, anno); giorno++){
+                data data = {giorno, mese, anno};
+                snprintf(ingresso, sizeof(ingresso), "%02d/%02d/%04d M", giorno, mese, anno);
+                ConfrontaCodifiche(date, ingresso, CodificaDataNascita(data, 'M'),
+                                   CodificaDataNascitaRiferimento(data, 'M'));
+                ingresso[11] = 'F';
+                ConfrontaCodifiche(date, ingresso, CodificaDataNascita(data, 'F'),
+                                   CodificaDataNascitaRiferimento(data, 'F'));
+            }
+        }
+    }
+}
+
+// Calcolo del carattere di controllo su sequenze casuali di 15 caratteri dell'alfabeto del codice fiscale
+static void ProvaCIN(uint64_t *stato, long numCasi, prova *cin, prova *carattereControllo, prova *blocco){
+    char codice[LEN_CF];
+    char ottenuto[2] = "", atteso[2] = "";
+    char codiciBlocco[LEN_BLOCCO_CIN][LEN_CF];
+    char attesiBlocco[LEN_BLOCCO_CIN], ottenutiBlocco[LEN_BLOCCO_CIN];
+    size_t numBlocco = 0;
+    for(long i=0; i<numCasi; i++){
+        for(int j=0; j<LEN_CF - 1; j++){
+            codice[j] = CARATTERI[CasualeLimitato(stato, sizeof(CARATTERI))];
+        }
+        codice[LEN_CF - 1] = '\0';
+        atteso[0] = CalcolaCINRiferimento(codice);
+        ottenuto[0] = CalcolaCIN(codice);
+        Confronta(cin, ottenuto[0] == atteso[0], codice, ottenuto, atteso);
+        ottenuto[0] = CalcolaCarattereControllo(codice);
+        Confronta(carattereControllo, ottenuto[0] == atteso[0], codice, ottenuto, atteso);
+
+        // I codici vengono accumulati e verificati a blocchi, compreso l'ultimo blocco incompleto
+        memcpy(codiciBlocco[numBlocco], codice, LEN_CF);
+        attesiBlocco[numBlocco++] = atteso[0];
+        if(numBlocco == LEN_BLOCCO_CIN || i == numCasi - 1){
+            CalcolaCarattereControlloBlocco((const char (*)[LEN_CF])codiciBlocco, numBlocco, ottenutiBlocco);
+            for(size_t j=0; j<numBlocco; j++){
+                ottenuto[0] = ottenutiBlocco[j];
+                atteso[0] = attesiBlocco[j];
+                Confronta(blocco, ottenuto[0] == atteso[0], codiciBlocco[j], ottenuto, atteso);
+            }
+            numBlocco = 0;
+        }
+    }
+}
+
+// Costruisce con l'implementazione di riferimento il codice fiscale atteso per la persona. Restituisce 0 in caso di
+// successo oppure il codice di errore della ricerca del codice catastale
+static int CodiceAtteso(const persona *p, char nome[], char cognome[], char atteso[LEN_CF + 1]){
+    char codCatastale[LEN_COD_CATASTALE];
+    int errore = CercaCodiceCatastaleRiferimento(p->luogoNascita, p->dataNascita, codCatastale);
+    if(errore != 0){
+        return errore;
+    }
+    char *codCognome = CodificaCognomeRiferimento(cognome);
+    char *codNome = CodificaNomeRiferimento(nome);
+    char *codData = CodificaDataNascitaRiferimento(p->dataNascita, p->sesso);
+    if(codCognome == NULL || codNome == NULL || codData == NULL){
+        free(codCognome);
+        free(codNome);
+        free(codData);
+        return ERR_ALLOCAZIONE;
+    }
+    memcpy(atteso + POS_COD_COGNOME, codCognome, LEN_COD_COGNOME);
+    memcpy(atteso + POS_COD_NOME, codNome, LEN_COD_NOME);
+    memcpy(atteso + POS_COD_DN, codData, LEN_COD_DN);
+    memcpy(atteso + POS_COD_CATASTALE, codCatastale, LEN_COD_CATASTALE);
+    atteso[POS_CIN] = '\0';
+    atteso[POS_CIN] = CalcolaCINRiferimento(atteso);
+    atteso[LEN_CF] = '\0';
+    free(codCognome);
+    free(codNome);
+    free(codData);
+    return 0;
+}
+
+// Caso della prova sul catalogo storico: luogo e data di nascita con l'esito e il codice catastale attesi
+typedef struct CASO_STORICO {
+    const char *luogo;
+    data dataNascita;
+    int errore;
+    const char *codice;
+}casoStorico;
+
+// Casi costruiti sui periodi di test/codiciCatastaliStorici.csv
+static const casoStorico CASI_STORICI[] = {
+    // Comune soppresso, in vigore dal 01/07/1910 al 31/12/1969
+    {"Vallefittizia", {30, 6, 1910}, ERR_LUOGO_NASCITA, ""},
+    {"Vallefittizia", {1, 7, 1910}, 0, "M900"},
+    {"Vallefittizia", {31, 12, 1969}, 0, "M900"},
+    {"Vallefittizia", {1, 1, 1970}, ERR_LUOGO_NASCITA, ""},
+    // Comune rinominato il 01/01/1960 mantenendo il codice
+    {"Borgo Vecchio Fittizio", {31, 12, 1959}, 0, "M901"},
+    {"Borgo Vecchio Fittizio", {1, 1, 1960}, ERR_LUOGO_NASCITA, ""},
+    {"Borgo Nuovo Fittizio", {31, 12, 1959}, ERR_LUOGO_NASCITA, ""},
+    {"Borgo Nuovo Fittizio", {1, 1, 1960}, 0, "M901"},
+    // Comune che esiste ancora con un codice diverso da quello in vigore fino al 31/12/1927
+    {"Agliè", {31, 12, 1927}, 0, "M902"},
+    {"Agliè (TO)", {15, 3, 1910}, 0, "M902"},
+    {"Agliè", {1, 1, 1928}, 0, "A074"},
+    // Omonimi di due province, entrambi in vigore dal 01/01/1930 al 31/12/1989
+    {"Montefittizio", {31, 12, 1929}, 0, "M903"},
+    {"Montefittizio", {1, 1, 1950}, ERR_LUOGO_AMBIGUO, ""},
+    {"Montefittizio (AL)", {1, 1, 1950}, 0, "M903"},
+    {"Montefittizio (PV)", {1, 1, 1950}, 0, "M904"},
+    {"Montefittizio", {1, 1, 1990}, 0, "M904"},
+    {"Montefittizio (AL)", {1, 1, 1990}, ERR_LUOGO_NASCITA, ""}
+};
+#define NUM_CASI_STORICI (int)(sizeof(CASI_STORICI) / sizeof(CASI_STORICI[0]))
+
+// Descrive l'esito di una ricerca: il codice catastale trovato oppure "ERRORE;<codice>"
+static void ScriviEsitoStorico(char esito[LEN_CF + 1], int errore, const char codice[LEN_COD_CATASTALE]){
+    if(errore == 0){
+        snprintf(esito, LEN_CF + 1, "%.4s", codice);
+    }
+    else{
+        snprintf(esito, LEN_CF + 1, "ERRORE;%d", errore);
+    }
+}
+
+// Ricerca dei codici catastali nel catalogo storico di prova: ogni caso viene confrontato sia con l'esito atteso sia
+// con la ricerca lineare di riferimento, e i codici fiscali ottenuti devono superare la validazione
+static void ProvaStorico(prova *storico){
+    if(CatalogoStoricoCondiviso() == NULL){
+        Confronta(storico, false, FILE_CODICI_STORICI, "file assente", "catalogo storico di prova");
+        return;
+    }
+    for(int i=0; i<NUM_CASI_STORICI; i++){
+        const casoStorico *caso = &CASI_STORICI[i];
+        char ottenuto[LEN_CF + 1] = "", atteso[LEN_CF + 1] = "", riferimento[LEN_CF + 1] = "";
+        char codice[LEN_COD_CATASTALE];
+        ScriviEsitoStorico(atteso, caso->errore, caso->codice);
+        int errore = CercaCodiceCatastale(caso->luogo, caso->dataNascita, codice);
+        ScriviEsitoStorico(ottenuto, errore, codice);
+        errore = CercaCodiceCatastaleRiferimento(caso->luogo, caso->dataNascita, codice);
+        ScriviEsitoStorico(riferimento, errore, codice);
+        Confronta(storico, strcmp(ottenuto, atteso) == 0, caso->luogo, ottenuto, atteso);
+        Confronta(storico, strcmp(riferimento, atteso) == 0, caso->luogo, riferimento, atteso);
+
+        // Il codice fiscale calcolato con un codice dello storico deve essere riconosciuto dalla validazione
+        persona p = {"Mario", "Rossi", 'M', caso->dataNascita, caso->luogo};
+        char codiceFiscale[LEN_CF + 1];
+        if(caso->errore == 0 && (CodificaPersona(&p, codiceFiscale) != 0
+                                 || ValidaCodiceFiscale(codiceFiscale, LEN_CF, ANNO_RIFERIMENTO) != CF_VALIDO)){
+            Confronta(storico, false, caso->luogo, codiceFiscale, "codice fiscale valido");
+        }
+    }
+}
+
+// Controlla le varianti per omocodia di un codice valido: ogni variante deve avere il carattere di controllo calcolato
+// dall'implementazione di riferimento e deve superare la validazione
+static bool VariantiCorrette(const char codiceFiscale[LEN_CF + 1], char errata[LEN_CF + 1]){
+    static char varianti[NUM_VARIANTI_OMOCODIA][LEN_CF + 1];
+    if(GeneraVariantiOmocodia(codiceFiscale, varianti) != 0){
+        strcpy(errata, codiceFiscale);
+        return false;
+    }
+    for(int m=0; m<NUM_VARIANTI_OMOCODIA; m++){
+        char parziale[LEN_CF];
+        memcpy(parziale, varianti[m], LEN_CF - 1);
+        parziale[LEN_CF - 1] = '\0';
+        if(varianti[m][POS_CIN] != CalcolaCINRiferimento(parziale)
+           || ValidaCodiceFiscale(varianti[m], LEN_CF, ANNO_RIFERIMENTO) != CF_VALIDO){
+            strcpy(errata, varianti[m]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Codifica e validazione di persone casuali nate nei comuni del catalogo. I record vengono anche scritti nel file
+// della prova sulla modalità batch e i codici attesi (oppure "ERRORE;<codice>") nell'array attesi
+static void ProvaPersone(uint64_t *stato, long numPersone, const catalogo *cat, FILE *record,
+                         char (*attesi)[LEN_MAX_RECORD], prova *persone, prova *validazione, prova *omocodia){
+    char nome[LEN_MAX_PAROLA + 1], cognome[LEN_MAX_PAROLA + 1], luogo[LEN_MAX_RECORD];
+    char ingresso[LEN_MAX_RECORD * 2];
+    for(long i=0; i<numPersone; i++){
+        ScriviParolaCasuale(stato, LEN_MIN_NOME, nome);
+        ScriviParolaCasuale(stato, LEN_MIN_COGNOME, cognome);
+        const comune *c = &cat->comuni[CasualeLimitato(stato, cat->numComuni)];
+        // I comuni omonimi sono distinti dalla sigla della provincia
+        int lenLuogo = c->lenNome < LEN_MAX_RECORD / 2 ? (int)c->lenNome : LEN_MAX_RECORD / 2;
+        if(c->provincia[0] != ' '){
+            snprintf(luogo, sizeof(luogo), "%.*s (%.2s)", lenLuogo, c->nome, c->provincia);
+        }
+        else{
+            snprintf(luogo, sizeof(luogo), "%.*s", lenLuogo, c->nome);
+        }
+        persona p = {nome, cognome, CasualeLimitato(stato, 2) ? 'F' : 'M', DataCasuale(stato, ANNO_RIFERIMENTO), luogo};
+        snprintf(ingresso, sizeof(ingresso), "%s;%s;%c;%02d/%02d/%04d;%s", nome, cognome, p.sesso,
+                 p.dataNascita.giorno, p.dataNascita.mese, p.dataNascita.anno, luogo);
+        fprintf(record, "%s\n", ingresso);
+
+        char ottenuto[LEN_CF + 1] = "", atteso[LEN_CF + 1] = "";
+        int erroreAtteso = CodiceAtteso(&p, nome, cognome, atteso);
+        int errore = CodificaPersona(&p, ottenuto);
+        if(erroreAtteso != 0 || errore != 0){
+            snprintf(attesi[i], LEN_MAX_RECORD, "ERRORE;%d", erroreAtteso);
+            snprintf(atteso, sizeof(atteso), "ERRORE;%d", erroreAtteso);
+            snprintf(ottenuto, sizeof(ottenuto), "ERRORE;%d", errore);
+            Confronta(persone, errore == erroreAtteso, ingresso, ottenuto, atteso);
+            continue;
+        }
+        strcpy(attesi[i], atteso);
+        Confronta(persone, strcmp(ottenuto, atteso) == 0, ingresso, ottenuto, atteso);
+
+        // Il codice corretto deve essere valido, mentre con qualsiasi altro carattere di controllo non deve esserlo
+        char errato[LEN_CF + 1];
+        strcpy(errato, atteso);
+        errato[POS_CIN] = (char)('A' + (atteso[POS_CIN] - 'A' + 1 + (int)CasualeLimitato(stato, 25)) % 26);
+        bool validazioneCorretta = ValidaCodiceFiscale(atteso, LEN_CF, ANNO_RIFERIMENTO) == CF_VALIDO
+                                   && ValidaCodiceFiscale(errato, LEN_CF, ANNO_RIFERIMENTO) == ERR_CF_CIN;
+        Confronta(validazione, validazioneCorretta, atteso, validazioneCorretta ? "" : errato, "");
+
+        char errata[LEN_CF + 1] = "";
+        bool variantiCorrette = VariantiCorrette(atteso, errata);
+        Confronta(omocodia, variantiCorrette, atteso, errata, "");
+    }
+}
+
+// Esegue la modalità batch parallela sul file dei record e confronta ogni riga in uscita con il codice atteso
+static void ProvaBatch(const char nomeFileRecord[], long numPersone, char (*attesi)[LEN_MAX_RECORD], prova *batch){
+    char nomeFileUscita[] = "/tmp/confrontoRiferimentoXXXXXX";
+    int fdUscita = mkstemp(nomeFileUscita);
+    if(fdUscita < 0){
+        Confronta(batch, false, nomeFileUscita, "file non creato", "");
+        return;
+    }
+    // Lo standard output viene temporaneamente rediretto sul file
+    fflush(stdout);
+    int fdStandard = dup(STDOUT_FILENO);
+    dup2(fdUscita, STDOUT_FILENO);
+    int errore = ModalitaBatch(nomeFileRecord, NULL, THREAD_BATCH, BATCH_CODIFICA);
+    fflush(stdout);
+    dup2(fdStandard, STDOUT_FILENO);
+    close(fdStandard);
+    close(fdUscita);
+
+    char codice[16];
+    snprintf(codice, sizeof(codice), "%d", errore);
+    Confronta(batch, errore == 0, nomeFileRecord, codice, "0");
+    FILE *uscita = fopen(nomeFileUscita, "r");
+    char riga[LEN_MAX_RECORD];
+    long i = 0;
+    while(uscita != NULL && fgets(riga, sizeof(riga), uscita) != NULL){
+        riga[strcspn(riga, "\r\n")] = '\0';
+        Confronta(batch, i < numPersone && strcmp(riga, attesi[i]) == 0, "riga del file dei record", riga,
+                  i < numPersone ? attesi[i] : "(nessuna riga)");
+        i++;
+    }
+    Confronta(batch, i == numPersone, "numero di righe", "", "");
+    if(uscita != NULL){
+        fclose(uscita);
+    }
+    remove(nomeFileUscita);
+}
+
+int main(int argc, char *argv[]) {
+    long numCasi = argc > 1 ? atol(argv[1]) : CASI_PREDEFINITI;
+    uint64_t stato = argc > 2 ? strtoull(argv[2], NULL, 10) : SEME_PREDEFINITO;
+    if(numCasi < 10){
+        fprintf(stderr, "UTILIZZO: %s [numero di casi] [seme]\n", argv[0]);
+        return ERR_DATI;
+    }
+    const catalogo *cat = CatalogoCondiviso();
+    if(cat == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere il file %s.\n", FILE_CODICI_CATASTALI);
+        return ERR_CATALOGO;
+    }
+    if(!CaricaCodiciRiferimento(FILE_CODICI_CATASTALI, FILE_CODICI_ESTERI, FILE_CODICI_STORICI)){
+        fprintf(stderr, "ERRORE FATALE. Impossibile leggere i file %s e %s.\n", FILE_CODICI_CATASTALI,
+                FILE_CODICI_ESTERI);
+        return ERR_CATALOGO;
+    }
+
+    prova prove[] = {
+        {"CodificaNome", 0, 0}, {"CodificaCognome", 0, 0}, {"CodificaDataNascita", 0, 0}, {"CalcolaCIN", 0, 0},
+        {"CalcolaCarattereControllo", 0, 0}, {"CarattereControlloBlocco", 0, 0}, {"CodificaPersona", 0, 0},
+        {"ValidaCodiceFiscale", 0, 0}, {"GeneraVariantiOmocodia", 0, 0}, {"ModalitaBatch", 0, 0},
+        {"CatalogoStorico", 0, 0}
+    };
+    int numProve = (int)(sizeof(prove) / sizeof(prove[0]));
+    ProvaNomi(&stato, numCasi, &prove[0], &prove[1]);
+    ProvaDate(&prove[2]);
+    ProvaCIN(&stato, numCasi, &prove[3], &prove[4], &prove[5]);
+
+    long numPersone = numCasi / 10;
+    char nomeFileRecord[] = "/tmp/confrontoRiferimentoXXXXXX";
+    int fdRecord = mkstemp(nomeFileRecord);
+    FILE *record = fdRecord >= 0 ? fdopen(fdRecord, "w") : NULL;
+    char (*attesi)[LEN_MAX_RECORD] = malloc((size_t)numPersone * LEN_MAX_RECORD);
+    if(record == NULL || attesi == NULL){
+        fprintf(stderr, "ERRORE FATALE. Impossibile preparare il file dei record.\n");
+        return ERR_FILE_USCITA;
+    }
+    ProvaPersone(&stato, numPersone, cat, record, attesi, &prove[6], &prove[7], &prove[8]);
+    fclose(record);
+    ProvaBatch(nomeFileRecord, numPersone, attesi, &prove[9]);
+    ProvaStorico(&prove[10]);
+    remove(nomeFileRecord);
+    free(attesi);
+
+    long differenze = 0;
+    for(int i=0; i<numProve; i++){
+        printf("%-26s %10ld casi  %ld differenze\n", prove[i].nome, prove[i].casi, prove[i].differenze);
+        differenze += prove[i].differenze;
+    }
+    return differenze == 0 ? 0 : 1;
+}
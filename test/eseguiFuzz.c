@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../codificaCF.h"
+
+/* PROGRAMMA: Esecuzione del punto di ingresso per libFuzzer senza libFuzzer
+ * Permette di eseguire LLVMFuzzerTestOneInput con qualsiasi compilatore: con uno o più file come argomenti esegue il
+ * controllo sul contenuto di ciascun file (ad esempio per riprodurre un ingresso trovato da libFuzzer), altrimenti lo
+ * esegue sul numero indicato di ingressi generati con un generatore casuale a seme fisso. Gli ingressi generati sono
+ * per un quarto byte qualsiasi, per un quarto parole composte da lettere, per un quarto codici fiscali con la struttura
+ * corretta (lettera del mese, giorno, codice catastale plausibile ed eventuali lettere di omocodia) e carattere di
+ * controllo casuale, in modo da arrivare a tutti i controlli della validazione, e per un quarto record della modalità
+ * batch con campi di lunghezza variabile e occasionali caratteri alterati, in modo da arrivare alla codifica.
+ * UTILIZZO: eseguiFuzz [numero di ingressi] oppure eseguiFuzz file...
+ * Termina con abort() alla prima differenza, come farebbe libFuzzer.
+ */
+
+// Numero predefinito di ingressi generati
+#define INGRESSI_PREDEFINITI 1000000L
+
+// Seme del generatore casuale
+#define SEME_FUZZ 0x2545F4914F6CDD1Du
+
+// Lunghezza massima degli ingressi generati (parole e byte qualsiasi), dei record generati e dei file letti
+#define LEN_MAX_GENERATO 24
+#define LEN_MAX_RECORD_GENERATO 64
+#define LEN_MAX_FILE (1 << 20)
+
+// Luoghi di nascita dei record generati: comuni, comuni omonimi con e senza provincia, stati esteri e nomi inesistenti
+static const char *LUOGHI_FUZZ[] = {"Torino", "Agliè", "Castro", "Castro (LE)", "Castro (XX)", "Francia", "Milano",
+                                    "torino", "Atlantide", ""};
+#define NUM_LUOGHI_FUZZ (int)(sizeof(LUOGHI_FUZZ) / sizeof(LUOGHI_FUZZ[0]))
+
+int LLVMFuzzerTestOneInput(const uint8_t *dati, size_t dim);
+
+// Generatore pseudocasuale splitmix64
+static uint64_t Casuale(uint64_t *stato){
+    uint64_t z = (*stato += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+// Restituisce un numero casuale da 0 a limite - 1
+static uint32_t CasualeLimitato(uint64_t *stato, uint32_t limite){
+    return (uint32_t)(((Casuale(stato) >> 32) * limite) >> 32);
+}
+
+// Scrive una cifra oppure, con probabilità 1/4, la lettera che la sostituisce in caso di omocodia
+static char CifraCasuale(uint64_t *stato){
+    int cifra = (int)CasualeLimitato(stato, 10);
+    return CasualeLimitato(stato, 4) == 0 ? CIFRE_OMOCODIA[cifra] : (char)('0' + cifra);
+}
+
+// Scrive un codice fiscale con la struttura corretta e restituisce la sua lunghezza
+static size_t CodiceCasuale(uint64_t *stato, uint8_t codice[LEN_CF]){
+    for(int i=0; i<LEN_CF; i++){
+        codice[i] = (uint8_t)('A' + CasualeLimitato(stato, 26));
+    }
+    codice[POS_COD_DN] = (uint8_t)CifraCasuale(stato);
+    codice[POS_COD_DN + 1] = (uint8_t)CifraCasuale(stato);
+    codice[POS_COD_DN + 2] = (uint8_t)MESI[1 + CasualeLimitato(stato, NUM_MESI)];
+    // Giorno da 1 a 31 o da 41 a 71, con occasionali valori fuori intervallo
+    int giorno = 1 + (int)CasualeLimitato(stato, 31) + (CasualeLimitato(stato, 2) ? 40 : 0);
+    if(CasualeLimitato(stato, 16) == 0){
+        giorno = (int)CasualeLimitato(stato, 100);
+    }
+    codice[POS_COD_DN + 3] = (uint8_t)('0' + giorno / 10);
+    codice[POS_COD_DN + 4] = (uint8_t)('0' + giorno % 10);
+    // I codici catastali dei comuni iniziano con le lettere da A a M, quelli degli stati esteri con Z
+    codice[POS_COD_CATASTALE] = (uint8_t)(CasualeLimitato(stato, 8) == 0 ? 'Z' : 'A' + CasualeLimitato(stato, 13));
+    for(int i=1; i<LEN_COD_CATASTALE; i++){
+        codice[POS_COD_CATASTALE + i] = (uint8_t)CifraCasuale(stato);
+    }
+    return LEN_CF;
+}
+
+// Scrive un campo numerico della data, di norma con il numero di cifre previsto e talvolta con una cifra in più o in
+// meno
+static int NumeroCasuale(uint64_t *stato, char numero[], int cifre){
+    if(CasualeLimitato(stato, 8) == 0){
+        cifre += (int)CasualeLimitato(stato, 3) - 1;
+    }
+    for(int i=0; i<cifre; i++){
+        numero[i] = (char)('0' + CasualeLimitato(stato, 10));
+    }
+    return cifre;
+}
+
+// Scrive un record nel formato della modalità batch ("nome;cognome;sesso;gg/mm/aaaa;luogo di nascita") e ne
+// restituisce la lunghezza
+static size_t RecordCasuale(uint64_t *stato, uint8_t record[LEN_MAX_RECORD_GENERATO]){
+    char nome[LEN_MAX_GENERATO], cognome[LEN_MAX_GENERATO], giorno[4], mese[4], anno[6];
+    int lenNome = (int)CasualeLimitato(stato, 10), lenCognome = (int)CasualeLimitato(stato, 10);
+    for(int i=0; i<lenNome; i++){
+        nome[i] = (char)((CasualeLimitato(stato, 2) ? 'A' : 'a') + CasualeLimitato(stato, 26));
+    }
+    for(int i=0; i<lenCognome; i++){
+        cognome[i] = (char)((CasualeLimitato(stato, 2) ? 'A' : 'a') + CasualeLimitato(stato, 26));
+    }
+    int lenGiorno = NumeroCasuale(stato, giorno, 2);
+    int lenMese = NumeroCasuale(stato, mese, 2);
+    int lenAnno = NumeroCasuale(stato, anno, 4);
+    char separatore = CasualeLimitato(stato, 8) == 0 ? '\t' : ';';
+    int len = snprintf((char*)record, LEN_MAX_RECORD_GENERATO, "%.*s%c%.*s%c%c%c%.*s/%.*s/%.*s%c%s",
+                       lenNome, nome, separatore, lenCognome, cognome, separatore, "MFmfX"[CasualeLimitato(stato, 5)],
+                       separatore, lenGiorno, giorno, lenMese, mese, lenAnno, anno, separatore,
+                       LUOGHI_FUZZ[CasualeLimitato(stato, NUM_LUOGHI_FUZZ)]);
+    if(len < 0){
+        return 0;
+    }
+    size_t dim = (size_t)len < LEN_MAX_RECORD_GENERATO ? (size_t)len : LEN_MAX_RECORD_GENERATO - 1;
+    // Con probabilità 1/4 un carattere viene sostituito da un separatore o da un byte qualsiasi
+    if(dim > 0 && CasualeLimitato(stato, 4) == 0){
+        uint8_t alterato = CasualeLimitato(stato, 2) ? (uint8_t)";/\t "[CasualeLimitato(stato, 4)] : (uint8_t)Casuale(stato);
+        record[CasualeLimitato(stato, (uint32_t)dim)] = alterato;
+    }
+    return dim;
+}
+
+// Scrive un ingresso casuale nel buffer e ne restituisce la lunghezza
+static size_t IngressoCasuale(uint64_t *stato, uint8_t ingresso[LEN_MAX_RECORD_GENERATO]){
+    size_t len = CasualeLimitato(stato, LEN_MAX_GENERATO + 1);
+    switch(CasualeLimitato(stato, 4)){
+        case 0:
+            for(size_t i=0; i<len; i++){
+                ingresso[i] = (uint8_t)Casuale(stato);
+            }
+            return len;
+        case 1:
+            for(size_t i=0; i<len; i++){
+                ingresso[i] = (uint8_t)((CasualeLimitato(stato, 2) ? 'A' : 'a') + CasualeLimitato(stato, 26));
+            }
+            return len;
+        case 2:
+            return CodiceCasuale(stato, ingresso);
+        default:
+            return RecordCasuale(stato, ingresso);
+    }
+}
+
+// Esegue il controllo sul contenuto di un file. Restituisce 0 in caso di successo, 1 se il file non è leggibile
+static int EseguiFile(const char nomeFile[], uint8_t *buffer){
+    FILE *file = fopen(nomeFile, "rb");
+    if(file == NULL){
+        fprintf(stderr, "ERRORE. Impossibile leggere il file %s.\n", nomeFile);
+        return 1;
+    }
+    size_t dim = fread(buffer, 1, LEN_MAX_FILE, file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(buffer, dim);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long numIngressi = INGRESSI_PREDEFINITI;
+    if(argc == 2 && strspn(argv[1], "0123456789") == strlen(argv[1])){
+        numIngressi = atol(argv[1]);
+    }
+    else if(argc > 1){
+        uint8_t *buffer = malloc(LEN_MAX_FILE);
+        if(buffer == NULL){
+            return 1;
+        }
+        int errori = 0;
+        for(int i=1; i<argc; i++){
+            errori += EseguiFile(argv[i], buffer);
+        }
+        free(buffer);
+        printf("%d file eseguiti\n", argc - 1 - errori);
+        return errori == 0 ? 0 : 1;
+    }
+
+    uint64_t stato = SEME_FUZZ;
+    uint8_t ingresso[LEN_MAX_RECORD_GENERATO];
+    for(long i=0; i<numIngressi; i++){
+        LLVMFuzzerTestOneInput(ingresso, IngressoCasuale(&stato, ingresso));
+    }
+    printf("%ld ingressi eseguiti\n", numIngressi);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../codiciErrore.h"
+#include "../codificaCF.h"
+#include "riferimento.h"
+
+/* MODULO: Punto di ingresso per libFuzzer sulla codifica e sulla validazione
+ * Ogni ingresso viene usato sia come nome e cognome (se ammessi dalla validazione dei dati) sia come codice fiscale da
+ * validare. Oltre agli errori di memoria rilevati dai sanitizer, il processo viene interrotto con abort() quando le
+ * funzioni della libreria non coincidono con l'implementazione di riferimento:
+ *  - CodificaNome, CodificaCognome e CalcolaCIN devono restituire gli stessi caratteri;
+ *  - CalcolaCarattereControllo deve coincidere con CalcolaCIN sui primi 15 caratteri;
+ *  - se ValidaCodiceFiscale arriva al controllo del carattere di controllo, l'esito deve dipendere solo dal
+ *    confronto con il carattere calcolato dall'implementazione di riferimento, e ogni codice valido deve poter essere
+ *    riportato ad un codice originale a sua volta valido;
+ *  - LeggiPersona, eseguita sull'ingresso come record della modalità batch, deve restituire campi privi di separatori
+ *    interni alla riga e una data con al più 2/2/4 cifre; se CodificaPersona calcola un codice, questo deve superare
+ *    la validazione.
+ * Viene compilato con -fsanitize=fuzzer (opzione COMPILA_FUZZER, solo con Clang) oppure con il programma eseguiFuzz,
+ * che esegue lo stesso controllo su ingressi casuali o su un insieme di file.
+ */
+
+// Lunghezza massima della parte dell'ingresso considerata
+#define LEN_MAX_INGRESSO 64
+
+// Anno di riferimento per la validazione
+#define ANNO_RIFERIMENTO_FUZZ 2024
+
+// Interpreta l'ingresso come record della modalità batch e controlla i campi ottenuti e il codice calcolato
+static void VerificaRecord(const uint8_t *dati, size_t dim){
+    // La riga viene copiata in un blocco della dimensione esatta (più il terminatore) perché LeggiPersona la modifica
+    char *riga = malloc(dim + 1);
+    if(riga == NULL){
+        return;
+    }
+    memcpy(riga, dati, dim);
+    riga[dim] = '\0';
+    persona p;
+    int errore = LeggiPersona(riga, &p);
+    if(errore != 0){
+        if(errore != ERR_DATI){
+            abort();
+        }
+        free(riga);
+        return;
+    }
+    const char *campi[] = {p.nome, p.cognome, p.luogoNascita};
+    for(int i=0; i<3; i++){
+        if(campi[i] < riga || campi[i] > riga + dim || strpbrk(campi[i], ";\t") != NULL){
+            abort();
+        }
+    }
+    if(p.dataNascita.giorno < 0 || p.dataNascita.giorno > 99 || p.dataNascita.mese < 0 || p.dataNascita.mese > 99
+       || p.dataNascita.anno < 0 || p.dataNascita.anno > 9999){
+        abort();
+    }
+
+    char codiceFiscale[LEN_CF + 1];
+    if(CodificaPersona(&p, codiceFiscale) == 0
+       && (strlen(codiceFiscale) != LEN_CF
+           || ValidaCodiceFiscale(codiceFiscale, LEN_CF, ANNO_RIFERIMENTO_FUZZ) != CF_VALIDO)){
+        abort();
+    }
+    free(riga);
+}
+
+// Interrompe il processo se le due codifiche (NULL se l'allocazione è fallita) non coincidono, quindi le libera
+static void VerificaCodifiche(char *ottenuto, char *atteso){
+    if(ottenuto != NULL && atteso != NULL && strcmp(ottenuto, atteso) != 0){
+        abort();
+    }
+    free(ottenuto);
+    free(atteso);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *dati, size_t dim){
+    char testo[LEN_MAX_INGRESSO + 1];
+    size_t len = dim < LEN_MAX_INGRESSO ? dim : LEN_MAX_INGRESSO;
+    memcpy(testo, dati, len);
+    testo[len] = '\0';
+
+    // Codifica: le funzioni di riferimento sono confrontabili solo sui dati ammessi dalla validazione
+    if(ValidaNome(testo)){
+        VerificaCodifiche(CodificaNome(testo), CodificaNomeRiferimento(testo));
+    }
+    if(ValidaCognome(testo)){
+        VerificaCodifiche(CodificaCognome(testo), CodificaCognomeRiferimento(testo));
+    }
+    // I caratteri estranei all'alfabeto non contribuiscono al calcolo in nessuna delle due implementazioni
+    if(CalcolaCIN(testo) != CalcolaCINRiferimento(testo)){
+        abort();
+    }
+
+    // Interpretazione come record della modalità batch
+    VerificaRecord(dati, dim);
+
+    // Validazione: l'ingresso viene copiato in un blocco della dimensione esatta per rilevare letture oltre la fine
+    char *codice = malloc(dim > 0 ? dim : 1);
+    if(codice == NULL){
+        return 0;
+    }
+    memcpy(codice, dati, dim);
+    int esito = ValidaCodiceFiscale(codice, dim, ANNO_RIFERIMENTO_FUZZ);
+    if(esito < CF_VALIDO || esito >= NUM_ESITI_CF){
+        abort();
+    }
+    if(dim == LEN_CF && memchr(codice, '\0', LEN_CF - 1) == NULL){
+        char parziale[LEN_CF];
+        memcpy(parziale, codice, LEN_CF - 1);
+        parziale[LEN_CF - 1] = '\0';
+        char cin = CalcolaCINRiferimento(parziale);
+        if(CalcolaCarattereControllo(codice) != cin){
+            abort();
+        }
+        if((esito == CF_VALIDO || esito == ERR_CF_CIN) && (esito == CF_VALIDO) != (codice[POS_CIN] == cin)){
+            abort();
+        }
+        if(esito == CF_VALIDO){
+            char canonico[LEN_CF + 1];
+            if(NormalizzaCodiceFiscale(codice, canonico, NULL) != 0
+               || ValidaCodiceFiscale(canonico, LEN_CF, ANNO_RIFERIMENTO_FUZZ) != CF_VALIDO){
+                abort();
+            }
+        }
+    }
+    free(codice);
+    return 0;
+}
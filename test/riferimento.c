@@ -0,0 +1,403 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "../codiciErrore.h"
+#include "riferimento.h"
+
+// Lunghezza massima di una riga dei file dei codici catastali
+#define LEN_RIGA_RIFERIMENTO 256
+
+// Lettere corrispondenti ai mesi per la codifica della data di nascita
+static const char MESI_RIFERIMENTO[NUM_MESI + 1] = "_ABCDEHLMPRST";
+
+// Alfabeti per la determinazione del CIN, riportati per esteso come nella prima versione in modo da non dipendere
+// dalle tabelle della libreria
+static const char CARATTERI_RIFERIMENTO[37] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const int VALORE_CARATTERI_DISPARI_RIFERIMENTO[36] = {1, 0, 5, 7, 9, 13, 15, 17, 19,
+                                                             21, 1, 0, 5, 7, 9, 13, 15,
+                                                             17, 19, 21, 2, 4, 18, 20, 11,
+                                                             3, 6, 8, 12, 14, 16, 10, 22,
+                                                             25, 24, 23};
+static const int VALORE_CARATTERI_PARI_RIFERIMENTO[36] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0,
+                                                          1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                                          11, 12, 13, 14, 15, 16, 17, 18, 19,
+                                                          20, 21, 22, 23, 24, 25};
+static const char CARATTERI_RESTO_RIFERIMENTO[27] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// Controlla se il carattere passato come parametro è una vocale italiana (secondo tabella ASCII standard)
+static bool IsVocaleRiferimento(char c){
+    if(c == 'a' || c == 'A' || c == 'e' || c == 'E' || c == 'i' || c == 'I' || c == 'o' || c == 'O' || c == 'u' || c == 'U'){
+        return true;
+    }
+    else{
+        return false;
+    }
+}
+
+// Conta le consonanti in una stringa passata come parametro
+static int ContaConsonantiRiferimento(char parola[]) {
+    int cont = 0;
+    for(size_t i=0; i < strlen(parola); i++) {
+        if(!IsVocaleRiferimento(parola[i])) {
+            cont++;
+        }
+    }
+    return cont;
+}
+
+// Restituisce la codifica del nome della persona
+char* CodificaNomeRiferimento(char nome[]) {
+    // La funzione restituisce un puntatore ad una stringa allocata dinamicamente
+    char *codNome = calloc(LEN_COD_NOME + 1, sizeof(char));
+    // Controllo di avvenuta allocazione
+    if(codNome == NULL){
+        return NULL;
+    }
+    // Uso una stringa temp per costruire la codifica per concatenazione
+    char temp[2] = "\0\0";
+    int numConsonanti = ContaConsonantiRiferimento(nome), contConsonanti = 0;
+    bool codiceIncompleto = false, lettereInsufficenti = false;
+
+    strcpy(codNome, "");
+    do {
+        if(lettereInsufficenti){
+            // Se le lettere sono insufficenti concateno il carattere di riempimento
+            strcat(codNome, "X");
+        }
+        else {
+            for (size_t i = 0; i < strlen(nome); i++) {
+                if (codiceIncompleto) {
+                    // Se il codice è incompleto aggiungo ad esso le vocali
+                    if (isalpha(nome[i]) && IsVocaleRiferimento(nome[i])) {
+                        temp[0] = nome[i];
+                        strcat(codNome, temp);
+                    }
+                    if(strlen(codNome) == LEN_COD_NOME){
+                        // Ad ogni vocale aggiunta controllo la lunghezza della codifica
+                        break;
+                    }
+                } else {
+                    // Inizio aggiungendo alla codifica le consonanti
+                    if (isalpha(nome[i]) && !IsVocaleRiferimento(nome[i])) {
+                        contConsonanti++;
+                        if(numConsonanti >= 4) {
+                            // Se il numero di consonanti è maggiore o ugale a 4 è necessario contarle
+                            if (contConsonanti == 1 || contConsonanti == 3 || contConsonanti == 4) {
+                                temp[0] = nome[i];
+                                strcat(codNome, temp);
+                            }
+                        }
+                        else {
+                            // Altrimenti le preleviamo indipendentemente
+                            temp[0] = nome[i];
+                            strcat(codNome, temp);
+                        }
+                    }
+                }
+            }
+        }
+        // Se dalla stringa del nome non sono stato in grado di estrarre 3 caratterri modifico il valore di questa flag
+        if (strlen(codNome) != LEN_COD_NOME) {
+            if(codiceIncompleto){
+                // Se la lunghezza non è coretta e il flag codiceIncompleto era già a valore TRUE
+                // ho determinato di non avere lettere a sufficenza
+                lettereInsufficenti = true;
+            }
+            codiceIncompleto = true;
+        }
+        else{
+            codiceIncompleto = false;
+        }
+        // Ripeto la procedura per permettere l'aggiunta delle vocali e degli eventuali caratteri di riempimento
+        // che durante la prima iterazione non vengono considerati
+    } while (codiceIncompleto);
+
+    // Converto tutta la stringa in maiuscolo
+    for(size_t i=0; i<strlen(codNome); i++){
+        codNome[i] = (char)toupper(codNome[i]);
+    }
+
+    return codNome;
+}
+
+// Restituisce la codifica del cognome della persona
+char* CodificaCognomeRiferimento(char cognome[]) {
+    // La funzione restituisce un puntatore ad una stringa allocata dinamicamente
+    char *codCognome = calloc(LEN_COD_COGNOME + 1, sizeof(char));
+    // Controllo di avvenuta allocazione
+    if(codCognome == NULL){
+        return NULL;
+    }
+    // Uso una stringa temp per costruire la codifica per concatenazione
+    char temp[2] = "\0\0";
+    int contConsonanti = 0;
+    bool codiceIncompleto = false, lettereInsufficenti = false;
+
+    strcpy(codCognome, "");
+    do {
+        if(lettereInsufficenti){
+            // Se le lettere sono insufficenti concateno il carattere di riempimento
+            strcat(codCognome, "X");
+        }
+        else {
+            for (size_t i = 0; i < strlen(cognome); i++) {
+                if (codiceIncompleto) {
+                    // Se il codice è incompleto aggiungo ad esso le vocali
+                    if (isalpha(cognome[i]) && IsVocaleRiferimento(cognome[i])) {
+                        temp[0] = cognome[i];
+                        strcat(codCognome, temp);
+                    }
+                    if(strlen(codCognome) == LEN_COD_NOME){
+                        // Ad ogni vocale aggiunta controllo la lunghezza della codifica
+                        break;
+                    }
+                } else {
+                    // Inizio aggiungendo alla codifica le consonanti
+                    if (isalpha(cognome[i]) && !IsVocaleRiferimento(cognome[i]) && contConsonanti < 3) {
+                        contConsonanti++;
+                        temp[0] = cognome[i];
+                        strcat(codCognome, temp);
+                    }
+                }
+            }
+        }
+        // Se dalla stringa del cognome non sono stato in grado di estrarre 3 caratterri modifico il valore di questo flag
+        if (strlen(codCognome) != LEN_COD_COGNOME) {
+            if(codiceIncompleto){
+                // Se la lunghezza non è coretta e il flag codiceIncompleto era già a valore TRUE
+                // ho determinato di non avere lettere a sufficenza
+                lettereInsufficenti = true;
+            }
+            codiceIncompleto = true;
+        }
+        else{
+            codiceIncompleto = false;
+        }
+        // Ripeto la procedura per permettere l'aggiunta delle vocali e degli eventuali caratteri di riempimento
+        // che durante la prima iterazione non vengono considerati
+    } while (codiceIncompleto);
+
+    // Converto tutta la stringa in maiuscolo
+    for(size_t i=0; i<strlen(codCognome); i++){
+        codCognome[i] = (char)toupper(codCognome[i]);
+    }
+
+    return codCognome;
+}
+
+// Restituisce la codifica della data di nascita della persona
+char* CodificaDataNascitaRiferimento(data data, char sesso){
+    // Utlizzo una stringa di appoggio per costruire la codifica per concatenazione (nella prima versione di 5
+    // caratteri: è stata allungata in modo che il compilatore non segnali il possibile troncamento di snprintf)
+    char temp[16] = "\0\0\0\0\0";
+
+    // Nella prima versione la stringa era allocata senza spazio per il terminatore, scritto poi oltre la fine del
+    // blocco dall'ultima concatenazione
+    char *codificaData = calloc(LEN_COD_DN + 1, sizeof(char));
+    if(codificaData == NULL){
+        return NULL;
+    }
+    strcpy(codificaData, "");
+
+    // Scrivo su una stringa di appoggio il contenuto dell'anno di nascita che è attualemte in formato "AAAA"
+    snprintf(temp, sizeof(temp), "%d", data.anno);
+    // Opero sui singoli caratteri per convertire il formato in "AA"
+    temp[0] = temp[2];
+    temp[1] = temp[3];
+    temp[2] = '\0';
+    temp[3] = '\0';
+    strcat(codificaData, temp);
+    // Rendo la stringa una stringa vuota
+    temp[1] = '\0';
+    temp[0] = '\0';
+
+    // Recupero la lettera associata al mese dall'aposito alfabeto
+    temp[0] = MESI_RIFERIMENTO[data.mese];
+    strcat(codificaData, temp);
+    strcpy(temp, "\0\0\0\0\0");
+
+    // Modifico il valore del giorno di nascita in base al sesso
+    if(sesso == 'F'){
+        data.giorno += 40;
+        // I giorni di nascita per i soggetti femminili figurano da 41 a 71 perciò sono tutti in formato "GG"
+        snprintf(temp, sizeof(temp), "%d", data.giorno);
+    }
+    else{
+        // I giorni di nascita per i soggetti maschili figurano invariati da 1 a 31 perciò ho la necessità di applicare
+        // metodi diversi in base al valore del giorno in modo che tutti abbiano il formato "GG"
+        if(data.giorno < 10){
+            snprintf(temp, sizeof(temp), "%d%d", 0, data.giorno);
+        }
+        else{
+            snprintf(temp, sizeof(temp), "%d", data.giorno);
+        }
+    }
+    strcat(codificaData, temp);
+
+    return codificaData;
+}
+
+// Calcola il CIN partendo dal codice fiscale parziale
+char CalcolaCINRiferimento(char codiceFiscaleParziale[]){
+    int resto = 0;
+    for(size_t i=0; i<strlen(codiceFiscaleParziale); i++){
+        // Per ogni carattere che compone il codice fiscale parziale
+        for(size_t j=0; j<strlen(CARATTERI_RIFERIMENTO); j++){
+            // Cerco la sua posizione all'interno dello specifico alfabeto
+            if(codiceFiscaleParziale[i] == CARATTERI_RIFERIMENTO[j]) {
+                // Una volta trovato in base alla sua posizione incremento il valore della variabile resto
+                // e ritorno al ciclo for superiore tramite l'istruzione break
+                if ((i+1) % 2 == 0) {
+                    resto += VALORE_CARATTERI_PARI_RIFERIMENTO[j];
+                    break;
+                }
+                else {
+                    resto += VALORE_CARATTERI_DISPARI_RIFERIMENTO[j];
+                    break;
+                }
+            }
+        }
+    }
+    // Calcolo il resto
+    resto = resto % 26;
+    // Restituisco il carattere corrispondendente del relativo alfabeto
+    return CARATTERI_RESTO_RIFERIMENTO[resto];
+}
+
+// Righe di un file CSV, lette una sola volta e scandite per intero ad ogni ricerca
+typedef struct RIGHE_RIFERIMENTO {
+    char **righe;
+    size_t numRighe;
+}righeRiferimento;
+
+// Righe dei file dei codici catastali e degli stati esteri e righe del catalogo storico
+static righeRiferimento righeCodici = {NULL, 0};
+static righeRiferimento righeStoriche = {NULL, 0};
+
+// Aggiunge all'elenco delle righe quelle del file indicato, senza il BOM iniziale e senza i caratteri di fine riga.
+// Restituisce false se il file non può essere letto o se l'allocazione fallisce
+static bool LeggiRigheRiferimento(const char nomeFile[], righeRiferimento *elenco){
+    FILE *file = fopen(nomeFile, "r");
+    if(file == NULL){
+        return false;
+    }
+    char stringaLetta[LEN_RIGA_RIFERIMENTO];
+    bool primaRiga = true;
+    while(fgets(stringaLetta, LEN_RIGA_RIFERIMENTO, file) != NULL){
+        char *riga = stringaLetta;
+        if(primaRiga && strncmp(riga, "\xEF\xBB\xBF", 3) == 0){
+            riga += 3;
+        }
+        primaRiga = false;
+        riga[strcspn(riga, "\r\n")] = '\0';
+        if(riga[0] == '\0'){
+            continue;
+        }
+        char **righe = realloc(elenco->righe, (elenco->numRighe + 1) * sizeof(char*));
+        char *copia = malloc(strlen(riga) + 1);
+        if(righe == NULL || copia == NULL){
+            free(copia);
+            fclose(file);
+            return false;
+        }
+        elenco->righe = righe;
+        elenco->righe[elenco->numRighe++] = strcpy(copia, riga);
+    }
+    fclose(file);
+    return true;
+}
+
+bool CaricaCodiciRiferimento(const char nomeFile[], const char nomeFileEsteri[], const char nomeFileStorico[]){
+    // Il catalogo storico è facoltativo come nella libreria
+    FILE *storico = fopen(nomeFileStorico, "r");
+    if(storico != NULL){
+        fclose(storico);
+        if(!LeggiRigheRiferimento(nomeFileStorico, &righeStoriche)){
+            return false;
+        }
+    }
+    return LeggiRigheRiferimento(nomeFile, &righeCodici) && LeggiRigheRiferimento(nomeFileEsteri, &righeCodici);
+}
+
+// Converte una data "gg/mm/aaaa" del catalogo storico in un numero aaaammgg (il campo vuoto indica un periodo ancora
+// in corso). Restituisce 0 se la data non è valida
+static long DataRiferimento(const char testo[], long vuota){
+    int giorno, mese, anno;
+    if(testo[0] == DIV_CHAR || testo[0] == '\0'){
+        return vuota;
+    }
+    if(sscanf(testo, "%2d/%2d/%4d", &giorno, &mese, &anno) != 3){
+        return 0;
+    }
+    return anno * 10000L + mese * 100L + giorno;
+}
+
+// Confronta il nome all'inizio della riga e, se indicata, la sigla che segue il separatore in posizione campoSigla.
+// Restituisce il campo successivo al nome oppure NULL se la riga non corrisponde
+static const char* ConfrontaRiga(const char riga[], const char nome[], size_t lenNome, const char *sigla,
+                                 int campoSigla){
+    if(strncmp(riga, nome, lenNome) != 0 || riga[lenNome] != DIV_CHAR){
+        return NULL;
+    }
+    if(sigla != NULL){
+        const char *campo = riga;
+        for(int i=0; i<campoSigla && campo != NULL; i++){
+            campo = strchr(campo, DIV_CHAR);
+            campo = campo != NULL ? campo + 1 : NULL;
+        }
+        if(campo == NULL || strncmp(campo, sigla, LEN_SIGLA_PROVINCIA) != 0 || campo[LEN_SIGLA_PROVINCIA] != '\0'){
+            return NULL;
+        }
+    }
+    return riga + lenNome + 1;
+}
+
+int CercaCodiceCatastaleRiferimento(const char luogoNascita[], data dataNascita, char codCatastale[LEN_COD_CATASTALE]){
+    // L'eventuale sigla della provincia nel formato "<luogo di nascita> (XX)" viene separata dal nome
+    size_t lenNome = strlen(luogoNascita);
+    const char *sigla = NULL;
+    if(lenNome > LEN_SIGLA_PROVINCIA + 3 && luogoNascita[lenNome - 1] == ')'
+       && luogoNascita[lenNome - LEN_SIGLA_PROVINCIA - 2] == '('
+       && luogoNascita[lenNome - LEN_SIGLA_PROVINCIA - 3] == ' '){
+        sigla = luogoNascita + lenNome - LEN_SIGLA_PROVINCIA - 1;
+        lenNome -= LEN_SIGLA_PROVINCIA + 3;
+    }
+
+    // Prima le righe del catalogo storico "<nome>;<codice>;<dal>;<al>[;<sigla>]" in vigore alla data di nascita, poi
+    // quelle dei file attuali "<nome>;<codice>[;<sigla>]": il nome deve coincidere esattamente e, se indicata, anche
+    // la sigla della provincia
+    long data = dataNascita.anno * 10000L + dataNascita.mese * 100L + dataNascita.giorno;
+    int numTrovati = 0;
+    for(size_t r=0; r<righeStoriche.numRighe; r++){
+        const char *codice = ConfrontaRiga(righeStoriche.righe[r], luogoNascita, lenNome, sigla, 4);
+        if(codice == NULL || strlen(codice) < LEN_COD_CATASTALE + 1){
+            continue;
+        }
+        const char *dal = codice + LEN_COD_CATASTALE + 1;
+        const char *al = strchr(dal, DIV_CHAR);
+        if(al == NULL || DataRiferimento(dal, 0) > data || DataRiferimento(al + 1, 99991231L) < data){
+            continue;
+        }
+        if(numTrovati++ == 0){
+            memcpy(codCatastale, codice, LEN_COD_CATASTALE);
+        }
+    }
+    if(numTrovati == 0){
+        for(size_t r=0; r<righeCodici.numRighe; r++){
+            const char *codice = ConfrontaRiga(righeCodici.righe[r], luogoNascita, lenNome, sigla, 2);
+            if(codice == NULL || strlen(codice) < LEN_COD_CATASTALE){
+                continue;
+            }
+            if(numTrovati++ == 0){
+                memcpy(codCatastale, codice, LEN_COD_CATASTALE);
+            }
+        }
+    }
+    if(numTrovati == 0){
+        return ERR_LUOGO_NASCITA;
+    }
+    return numTrovati > 1 ? ERR_LUOGO_AMBIGUO : 0;
+}
@@ -0,0 +1,31 @@
+#ifndef RIFERIMENTO_H
+#define RIFERIMENTO_H
+
+#include "../codificaCF.h"
+
+/* MODULO: Implementazione di riferimento della codifica
+ * Copia delle funzioni CodificaNome, CodificaCognome, CodificaDataNascita e CalcolaCIN così come erano nella prima
+ * versione del programma (calcolo per concatenazione di stringhe e ricerca lineare negli alfabeti), con le sole
+ * modifiche necessarie a compilarle senza avvisi e senza terminare il processo. Serve come termine di confronto per le
+ * versioni ottimizzate della libreria: le due implementazioni devono produrre sempre gli stessi caratteri.
+ * La ricerca del codice catastale scandisce linearmente le righe dei file CSV come la prima versione, senza usare il
+ * catalogo della libreria: prima quelle del catalogo storico in vigore alla data di nascita, poi quelle dei comuni e
+ * degli stati esteri, distinguendo i comuni omonimi con la sigla della provincia.
+ */
+
+// Le stringhe restituite sono allocate dinamicamente (NULL se l'allocazione fallisce) e devono essere liberate dal
+// chiamante
+char* CodificaNomeRiferimento(char nome[]);
+char* CodificaCognomeRiferimento(char cognome[]);
+char* CodificaDataNascitaRiferimento(data data, char sesso);
+char CalcolaCINRiferimento(char codiceFiscaleParziale[]);
+
+// Legge una volta per tutte le righe dei file dei codici catastali, degli stati esteri e del catalogo storico
+// (facoltativo). Restituisce false se uno dei file non può essere letto
+bool CaricaCodiciRiferimento(const char nomeFile[], const char nomeFileEsteri[], const char nomeFileStorico[]);
+
+// Cerca il luogo di nascita ("<nome>" oppure "<nome> (XX)") tra le righe lette. Restituisce 0 in caso di successo,
+// ERR_LUOGO_NASCITA se nessuna riga corrisponde oppure ERR_LUOGO_AMBIGUO se ne corrisponde più di una
+int CercaCodiceCatastaleRiferimento(const char luogoNascita[], data dataNascita, char codCatastale[LEN_COD_CATASTALE]);
+
+#endif